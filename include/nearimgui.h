@@ -1,23 +1,53 @@
 #pragma once
 #include <imgui.h>
 #include <imgui_internal.h>
+#include <string>
 #include <string_view>
 #include <format>
 #include <optional>
 #include <variant>
 #include <span>
+#include <source_location>
 #include <utility>
 #include <functional>
 #include <ranges>
+#include <vector>
+#include <memory>
+#include <array>
+#include <bit>
+#include <new>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <filesystem>
 #include <misc/cpp/imgui_stdlib.h>
 
 #include <iostream>
 
+// Stateful callbacks passed to immediate ImGui calls (e.g. TextBox callbacks) up to this size are stored on the stack rather than the heap
+#ifndef NGUI_INLINE_CALLBACK_SIZE
+#define NGUI_INLINE_CALLBACK_SIZE 64
+#endif
+
 namespace NGui
 {
     namespace ImGuiExt
     {
         bool AngularDragScalar(const char* label, ImGuiDataType data_type, void* p_data, float v_speed, const void* p_min = NULL, const void* p_max = NULL, const char* format = NULL, ImGuiSliderFlags flags = 0);
+
+        // Variants of ImGui widgets taking a precomputed ID, end of the visible label and label size, so none of them needs to be derived from the label again.
+        bool ButtonEx(ImGuiID id, const char* label, const char* label_end, const ImVec2& label_size, const ImVec2& size_arg = ImVec2(0, 0), ImGuiButtonFlags flags = 0);
+        bool Checkbox(ImGuiID id, const char* label, const char* label_end, const ImVec2& label_size, bool* v);
+
+        // Selectable identified by an integer pushed on the ID stack, showing a label which does not need to be null-terminated.
+        bool Selectable(int id, const char* label, const char* label_end, bool selected, ImGuiSelectableFlags flags = 0);
+
+        // Unframed tree node row which takes its open state from the caller rather than the window storage, toggling *open when expanded or collapsed.
+        // Returns true when the row was clicked without being toggled.
+        bool TreeNodeRow(ImGuiID id, const char* label, const char* label_end, float indent, bool leaf, bool selected, bool* open);
     }
 
     template<typename E> requires std::is_enum_v<E>
@@ -45,6 +75,7 @@ namespace NGui
     template<> constexpr bool EnableFlagOperators<ImGuiSeparatorFlags_> = true;
     template<> constexpr bool EnableFlagOperators<ImGuiFocusRequestFlags_> = true;
     template<> constexpr bool EnableFlagOperators<ImGuiTextFlags_> = true;
+    template<> constexpr bool EnableFlagOperators<ImGuiMultiSelectFlags_> = true;
     template<> constexpr bool EnableFlagOperators<ImGuiTooltipFlags_> = true;
     template<> constexpr bool EnableFlagOperators<ImGuiNextWindowDataFlags_> = true;
     template<> constexpr bool EnableFlagOperators<ImGuiNextItemDataFlags_> = true;
@@ -104,6 +135,126 @@ namespace NGui
         return a;
     }
 
+    // Values scanned for enumerator names by EnumCombo and EnumRadio, specialize to widen it. Flag enums scan their bits instead.
+    template<typename E> requires std::is_enum_v<E>
+    struct EnumRange
+    {
+        static constexpr int min = std::is_signed_v<std::underlying_type_t<E>> ? -16 : 0;
+        static constexpr int max = 127;
+    };
+
+    template<typename E>
+    struct EnumEntry
+    {
+        E value;
+        const char* name;
+    };
+
+    // Specialize with a static constexpr std::array<EnumEntry<E>, N> entries to name an enum's values explicitly rather than through reflection.
+    template<typename E>
+    struct EnumNames {};
+
+    namespace Detail
+    {
+        // Enumerator name as it appears in this function's signature, empty if V is not the value of an enumerator
+        template<auto V>
+        constexpr std::string_view GetEnumValueName()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            constexpr std::string_view signature = __FUNCSIG__;
+            constexpr std::string_view prefix = "GetEnumValueName<";
+            constexpr size_t begin = signature.find(prefix) + prefix.size();
+            constexpr size_t end = signature.rfind(">(void)");
+#else
+            constexpr std::string_view signature = __PRETTY_FUNCTION__;
+            constexpr std::string_view prefix = "V = ";
+            constexpr size_t begin = signature.find(prefix) + prefix.size();
+            constexpr size_t end = signature.find_first_of(";]", begin);
+#endif
+            // Values without an enumerator are printed as casts, e.g. (Color)5
+            const std::string_view name = signature.substr(begin, end - begin);
+            if (name.empty() || !(name[0] == '_' || (name[0] >= 'A' && name[0] <= 'Z') || (name[0] >= 'a' && name[0] <= 'z')))
+                return {};
+
+            return name.substr(name.find_last_of(':') + 1);
+        }
+
+        // Null-terminated copy of the name, so it can be passed to ImGui as is
+        template<auto V>
+        struct EnumValueName
+        {
+            static constexpr std::string_view view = GetEnumValueName<V>();
+            static constexpr auto storage = [] {
+                std::array<char, view.size() + 1> text{};
+                std::ranges::copy(view, text.begin());
+                return text;
+            }();
+        };
+
+        template<typename E>
+        constexpr size_t EnumCandidateCount = EnableFlagOperators<E> ? sizeof(E) * 8 : static_cast<size_t>(EnumRange<E>::max - EnumRange<E>::min + 1);
+
+        // bit_cast rather than static_cast, as values outside an unscoped enum's range cannot be converted in constant expressions
+        template<typename E, size_t I>
+        constexpr E GetEnumCandidate()
+        {
+            using U = std::underlying_type_t<E>;
+            if constexpr (EnableFlagOperators<E>)
+                return std::bit_cast<E>(static_cast<U>(std::make_unsigned_t<U>(1) << I));
+            else
+                return std::bit_cast<E>(static_cast<U>(EnumRange<E>::min + static_cast<int>(I)));
+        }
+
+        template<typename E, size_t... I>
+        constexpr auto ReflectEnum(std::index_sequence<I...>)
+        {
+            constexpr std::array<bool, sizeof...(I)> valid{ !EnumValueName<GetEnumCandidate<E, I>()>::view.empty()... };
+            std::array<EnumEntry<E>, std::ranges::count(valid, true)> entries{};
+            size_t count = 0;
+            ((valid[I] ? void(entries[count++] = { GetEnumCandidate<E, I>(), EnumValueName<GetEnumCandidate<E, I>()>::storage.data() }) : void()), ...);
+            return entries;
+        }
+
+        template<typename E>
+        constexpr auto GetEnumEntries()
+        {
+            if constexpr (requires { EnumNames<E>::entries; })
+                return EnumNames<E>::entries;
+            else
+                return ReflectEnum<E>(std::make_index_sequence<EnumCandidateCount<E>>{});
+        }
+
+        // Enumerators of E in ascending order (unless given by EnumNames), computed once at compile time
+        template<typename E>
+        constexpr auto EnumEntries = GetEnumEntries<E>();
+
+        // Index of value in EnumEntries<E>, -1 if it has no entry. Direct when the values are consecutive, as they usually are.
+        template<typename E>
+        int FindEnumEntry(E value)
+        {
+            constexpr auto& entries = EnumEntries<E>;
+            constexpr bool consecutive = [] {
+                for (size_t i = 1; i < entries.size(); ++i)
+                    if (static_cast<ImS64>(ToUnderlying(entries[i].value)) != static_cast<ImS64>(ToUnderlying(entries[0].value)) + static_cast<ImS64>(i))
+                        return false;
+                return !entries.empty();
+            }();
+
+            if constexpr (consecutive)
+            {
+                const ImS64 index = static_cast<ImS64>(ToUnderlying(value)) - static_cast<ImS64>(ToUnderlying(entries[0].value));
+                return index >= 0 && index < static_cast<ImS64>(entries.size()) ? static_cast<int>(index) : -1;
+            }
+            else
+            {
+                for (size_t i = 0; i < entries.size(); ++i)
+                    if (entries[i].value == value)
+                        return static_cast<int>(i);
+                return -1;
+            }
+        }
+    }
+
     template<typename T, typename F = std::function<bool(T)>> requires std::convertible_to<std::invoke_result_t<F, const T&>, bool>
     class Validated
     {
@@ -146,6 +297,18 @@ namespace NGui
         static constexpr float value = -1.f;
     } Preserve;
 
+    /**
+     * Tag which makes FormatArgs reuse the string formatted on a previous frame when the arguments have not changed, e.g. NGui::Text({ NGui::Memoize, "counter = {}", counter }).
+     * Results are keyed by the call site and the current ID scope, so a call site repeated in a loop should push a distinct ID per iteration.
+    */
+    static constexpr struct MemoizeT {} Memoize;
+
+    /**
+     * Tag which keeps a stateful callback alive across frames instead of rebuilding it every frame, e.g. NGui::Window.SizeConstraints(NGui::Persistent, [&](auto* data) { ... }).
+     * Callbacks are keyed by the current ID scope and the callable type. The stored callable is reassigned in place each frame and dropped once unused for a while.
+    */
+    static constexpr struct PersistentT {} Persistent;
+
     namespace Detail
     {
         template<typename T>
@@ -157,9 +320,186 @@ namespace NGui
         template<typename T>
         concept IsValidatedNumber = IsValidated<T> && Numeric<typename T::Type>;
 
+        // Ranges the clipped widgets index into, they need the element count up front
+        template<typename R>
+        concept SizedRandomAccessRange = std::ranges::random_access_range<R> && std::ranges::sized_range<R>;
+
         template<typename... Ts>
         struct Overloaded : Ts... { using Ts::operator()...; };
 
+        /**
+         * Bump allocator for data which only needs to live until the next call to NGui::NewFrame().
+         * Blocks are kept between frames and merged into a single one on reset, so a stable workload stops allocating after a few frames.
+        */
+        class FrameArena
+        {
+            struct Block
+            {
+                std::unique_ptr<char[]> data;
+                size_t size = 0;
+            };
+
+            // Intrusive list of objects to destroy on reset, allocated in the arena itself
+            struct Destructor
+            {
+                void (*destroy)(void*);
+                void* object;
+                Destructor* next;
+            };
+
+            std::vector<Block> blocks_;
+            size_t used_ = 0;
+            Destructor* destructors_ = nullptr;
+
+            void AddBlock(size_t minimumSize);
+            void RunDestructors();
+
+        public:
+            FrameArena() = default;
+            FrameArena(const FrameArena&) = delete;
+            FrameArena& operator=(const FrameArena&) = delete;
+            ~FrameArena();
+
+            char* Allocate(size_t size, size_t alignment = 1);
+
+            /**
+             * Constructs an object in the arena. Non-trivial destructors are run in reverse construction order when the arena is reset.
+            */
+            template<typename T, typename... Args>
+            T* New(Args&& ...args)
+            {
+                if constexpr (std::is_trivially_destructible_v<T>)
+                    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+                else
+                {
+                    auto* destructor = new (Allocate(sizeof(Destructor), alignof(Destructor))) Destructor{ [](void* object) { static_cast<T*>(object)->~T(); }, nullptr, destructors_ };
+                    T* object = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+                    destructor->object = object;
+                    destructors_ = destructor;
+                    return object;
+                }
+            }
+
+            /**
+             * Returns the free space at the end of the current block, starting a new block if fewer than minimumSize bytes are left.
+             * The next unaligned Allocate() which fits in that space is guaranteed to return its first byte.
+            */
+            std::span<char> GetAvailable(size_t minimumSize);
+
+            void Reset();
+        };
+
+        FrameArena& GetFrameArena();
+
+        // Counts style pushes skipped by Style() because they would not have changed anything, reported in FrameStats.
+        void RecordElidedStylePushes(size_t count);
+
+        /**
+         * Formats directly into frame storage, without going through a temporary std::string.
+         * @return A view of the null-terminated result, valid until the next call to NGui::NewFrame().
+        */
+        template<typename... Args>
+        std::string_view FormatToFrame(std::format_string<Args...> fmt, Args&& ...args)
+        {
+            auto& arena = GetFrameArena();
+            auto available = arena.GetAvailable(256);
+
+            // Keep one byte for the null terminator
+            const auto size = static_cast<size_t>(std::format_to_n(available.data(), available.size() - 1, fmt, std::forward<Args>(args)...).size);
+
+            char* buf = arena.Allocate(size + 1);
+            // Did not fit: buf is now in a block large enough, format again. std::format only reads its arguments, so forwarding them twice is safe.
+            if (buf != available.data())
+                std::format_to(buf, fmt, std::forward<Args>(args)...);
+
+            buf[size] = '\0';
+            return { buf, size };
+        }
+
+        // Passes the bytes a memoized argument is compared by to visit: the length and characters of strings, the object representation of anything else.
+        template<typename T>
+        void VisitFormatArgumentBytes(const T& value, auto&& visit)
+        {
+            if constexpr (std::convertible_to<const T&, std::string_view>)
+            {
+                const std::string_view text = value;
+                const size_t size = text.size();
+                visit(std::string_view(reinterpret_cast<const char*>(&size), sizeof(size)));
+                visit(text);
+            }
+            else if constexpr (IsValidated<T>)
+                VisitFormatArgumentBytes(value.get(), visit);
+            else
+            {
+                static_assert(std::is_trivially_copyable_v<T>, "Memoized format arguments must be strings or trivially copyable.");
+                visit(std::string_view(reinterpret_cast<const char*>(&value), sizeof(T)));
+            }
+        }
+
+        // Format string of a memoized call along with the call site, captured where the FormatArgs is constructed
+        template<typename... Args>
+        struct MemoizedFormat
+        {
+            std::format_string<Args...> fmt;
+            std::source_location location;
+
+            template<typename S> requires std::convertible_to<const S&, std::string_view>
+            consteval MemoizedFormat(const S& format, std::source_location location = std::source_location::current())
+                : fmt(format), location(location) {}
+        };
+
+        struct MemoizedString
+        {
+            const char* format = nullptr;
+            std::string arguments; // Bytes of the arguments value was formatted from, see VisitFormatArgumentBytes
+            int lastFrame = -1;
+            std::string value;
+        };
+
+        MemoizedString& GetMemoizedString(ImGuiID key);
+
+        /**
+         * Same as FormatToFrame, but returns the string formatted by this call site in the current ID scope on a previous frame if the arguments are unchanged.
+         * @return A view of the null-terminated result, valid until the next call to NGui::NewFrame().
+        */
+        template<typename... Args>
+        std::string_view FormatMemoized(std::source_location location, std::format_string<Args...> fmt, Args&& ...args)
+        {
+            const struct { const char* file; std::uint_least32_t line, column; } site{ location.file_name(), location.line(), location.column() };
+            auto& entry = GetMemoizedString(ImHashData(&site, sizeof(site), ImGui::GetCurrentWindow()->IDStack.back()));
+            const char* format = fmt.get().data();
+            const int frame = ImGui::GetFrameCount();
+
+            if (entry.format == format && entry.lastFrame >= 0)
+            {
+                std::string_view stored = entry.arguments;
+                bool same = true;
+                const auto compare = [&](std::string_view bytes) {
+                    same = same && stored.starts_with(bytes);
+                    stored.remove_prefix(same ? bytes.size() : 0);
+                };
+                (VisitFormatArgumentBytes(args, compare), ...);
+
+                if (same && stored.empty())
+                {
+                    entry.lastFrame = frame;
+                    return entry.value;
+                }
+            }
+
+            // The entry was already handed out this frame with other arguments, its pointer must stay valid
+            if (entry.lastFrame == frame)
+                return FormatToFrame(fmt, std::forward<Args>(args)...);
+
+            entry.arguments.clear();
+            (VisitFormatArgumentBytes(args, [&](std::string_view bytes) { entry.arguments.append(bytes); }), ...);
+            entry.value.clear();
+            std::format_to(std::back_inserter(entry.value), fmt, std::forward<Args>(args)...);
+            entry.format = format;
+            entry.lastFrame = frame;
+            return entry.value;
+        }
+
         const char* CacheString(std::string_view sv);
         const char* CacheString(std::string&& s);
 
@@ -173,23 +513,33 @@ namespace NGui
             return s;
         }
 
-        struct BaseCallback
-        {
-            BaseCallback(const BaseCallback&) = delete;
-            BaseCallback(BaseCallback&&) = delete;
-            virtual ~BaseCallback() = default;
-
-        protected:
-            BaseCallback() = default;
-        };
-
+        /**
+         * Storage for a callback which only needs to outlive the ImGui call it is passed to.
+         * Callables up to NGUI_INLINE_CALLBACK_SIZE bytes are kept inline, larger ones fall back to the heap.
+        */
         template<typename F>
-        struct Callback : BaseCallback
+        class LocalCallback
         {
-            Callback(F&& cb) : callback(std::move(cb)) {}
-            ~Callback() override = default;
+            static constexpr bool IsInline = sizeof(F) <= NGUI_INLINE_CALLBACK_SIZE && alignof(F) <= alignof(std::max_align_t);
 
-            F callback;
+            std::conditional_t<IsInline, F, std::unique_ptr<F>> callback_;
+
+        public:
+            explicit LocalCallback(F&& callback)
+                : callback_([&] {
+                    if constexpr (IsInline)
+                        return std::move(callback);
+                    else
+                        return std::make_unique<F>(std::move(callback));
+                    }()) {}
+
+            F* get()
+            {
+                if constexpr (IsInline)
+                    return &callback_;
+                else
+                    return callback_.get();
+            }
         };
 
         template<typename C>
@@ -212,16 +562,130 @@ namespace NGui
         template<typename C>
         concept IsVoidPointerStyleCallback = IsVoidPtr<std::tuple_element_t<CallbackTraits<C>::ArgumentCount - 1, typename CallbackTraits<C>::Arguments>>;
 
-        BaseCallback* CacheCallback(std::unique_ptr<BaseCallback>&& callback);
+        enum class CallbackStorage
+        {
+            Local,      // Owned by the returned pair, for callbacks which ImGui only invokes before returning
+            Frame,      // Kept in the frame arena until the next NewFrame()
+            Persistent, // Kept across frames under the current ID and callable type, reassigned in place every frame
+        };
+
+        struct PersistentCallback
+        {
+            void* object = nullptr;
+            void (*destroy)(void*) = nullptr;
+            const void* type = nullptr; // TypeTag of the stored callable
+            int lastFrame = -1;
+
+            PersistentCallback() = default;
+            PersistentCallback(const PersistentCallback&) = delete;
+            PersistentCallback& operator=(const PersistentCallback&) = delete;
+            ~PersistentCallback()
+            {
+                if (destroy)
+                    destroy(object);
+            }
+        };
+
+        PersistentCallback& GetPersistentCallback(ImGuiID key);
+
+        // Address unique to T. Writable so that identical COMDAT folding (/OPT:ICF) cannot merge the tags of different types.
+        template<typename T>
+        inline char TypeTag = 0;
+
+        // Object kept across frames for a widget which needs more state than ImGui stores, released once the widget has gone unused for io.ConfigMemoryCompactTimer.
+        struct WidgetState
+        {
+            void* object = nullptr;
+            void (*destroy)(void*) = nullptr;
+            const void* type = nullptr; // TypeTag of the stored object
+            double lastTime = 0.0;
+
+            WidgetState() = default;
+            WidgetState(const WidgetState&) = delete;
+            WidgetState& operator=(const WidgetState&) = delete;
+            ~WidgetState()
+            {
+                if (destroy)
+                    destroy(object);
+            }
+        };
+
+        WidgetState& GetWidgetStateEntry(ImGuiID key);
+
+        // Returns the state of type T for the widget with the given ID, default-constructing it on first use.
+        // Should the key collide with another widget's state of a different type, that state is replaced rather than reinterpreted.
+        template<typename T>
+        T& GetWidgetState(ImGuiID id)
+        {
+            const void* type = &TypeTag<T>;
+            auto& entry = GetWidgetStateEntry(ImHashData(&type, sizeof(type), id));
+            entry.lastTime = ImGui::GetTime();
+
+            if (entry.object && entry.type != type)
+            {
+                entry.destroy(entry.object);
+                entry.object = nullptr;
+            }
+
+            if (!entry.object)
+            {
+                entry.object = new T();
+                entry.destroy = [](void* object) { delete static_cast<T*>(object); };
+                entry.type = type;
+            }
+
+            return *static_cast<T*>(entry.object);
+        }
+
+        template<CallbackStorage Storage, typename F>
+        auto StoreCallback(F&& callback)
+        {
+            if constexpr (Storage == CallbackStorage::Local)
+                return LocalCallback<F>(std::move(callback));
+            else if constexpr (Storage == CallbackStorage::Frame)
+                return GetFrameArena().New<F>(std::move(callback));
+            else
+            {
+                const void* type = &TypeTag<F>;
+                auto& entry = GetPersistentCallback(ImGui::GetID(type));
+                const int frame = ImGui::GetFrameCount();
+
+                // Already handed out this frame, e.g. in a loop without a distinct ID, or the key collided with another callable type's:
+                // keep that one intact
+                if (entry.lastFrame == frame || (entry.object && entry.type != type))
+                    return GetFrameArena().New<F>(std::move(callback));
+
+                entry.lastFrame = frame;
+                if (!entry.object)
+                {
+                    entry.object = new F(std::move(callback));
+                    entry.destroy = [](void* object) { delete static_cast<F*>(object); };
+                    entry.type = type;
+                    return static_cast<F*>(entry.object);
+                }
+
+                auto* cb = static_cast<F*>(entry.object);
+                if constexpr (std::is_move_assignable_v<F>)
+                    *cb = std::move(callback);
+                else
+                {
+                    // Lambdas with captures cannot be assigned, rebuild in place instead
+                    std::destroy_at(cb);
+                    std::construct_at(cb, std::move(callback));
+                }
+                return cb;
+            }
+        }
 
         /**
          * Given a callable with no state and which can be implicitly converted to a function pointer, passes callback along unchanged and does not set the user data void pointer.
          * @tparam C ImGui callback type to match.
+         * @tparam Storage Where to keep stateful callbacks (unused here).
          * @tparam F Provided callable type.
          * @param callback The callback.
          * @return A pair containing the function pointer callback and the user data pointer (here, always null).
         */
-        template<typename C, bool Cache, typename F>
+        template<typename C, CallbackStorage Storage, typename F>
         requires std::convertible_to<F, C>
         std::pair<C, void*> ThunkCallback(F&& callback)
         {
@@ -229,63 +693,71 @@ namespace NGui
         }
 
         /**
-         * Given a callable which cannot be implictly converted to a function pointer, caches it and returns a thunk which wraps the call to it
+         * Given a callable which cannot be implictly converted to a function pointer, stores it and returns a thunk which wraps the call to it
          * into a function pointer-convertible callback leveraging ImGui's user data pointer.
          * This overload works on callbacks with a void* user_data as the last argument.
          * @tparam C ImGui callback type to match.
+         * @tparam Storage Where to keep the stateful callback.
          * @tparam F Provided callable type.
          * @param callback The callback.
          * @return A pair containing the function pointer callback and the user data pointer storing the stateful callback.
         */
-        template<typename C, bool Cache, typename F>
+        template<typename C, CallbackStorage Storage, typename F>
         requires (!std::convertible_to<F, C>) && IsVoidPointerStyleCallback<C>
         auto ThunkCallback(F&& callback)
         {
-            auto cb = [&] {
-                auto c = std::make_unique<Callback<F>>(std::move(callback));
-                if constexpr (Cache)
-                    return static_cast<Callback<F>*>(CacheCallback(std::move(c)));
-                else
-                    return std::move(c);
-                }();
+            auto cb = StoreCallback<Storage>(std::move(callback));
 
-            return [=]<typename R, typename... Args>(R(*)(Args..., void*)) {
+            return [&]<typename R, typename... Args>(R(*)(Args..., void*)) {
                 return std::make_pair([](Args&& ...args, void* user_data) {
-                    return static_cast<Callback<F>*>(user_data)->callback(std::forward<Args>(args)...);
+                    return (*static_cast<F*>(user_data))(std::forward<Args>(args)...);
                     }, std::move(cb));
             }(static_cast<C>(nullptr));
         }
 
         /**
-         * Given a callable which cannot be implictly converted to a function pointer, caches it and returns a thunk which wraps the call to it
+         * Given a callable which cannot be implictly converted to a function pointer, stores it and returns a thunk which wraps the call to it
          * into a function pointer-convertible callback leveraging ImGui's user data pointer.
          * This overload works on callbacks with a Data* pointer which contains a void* pointer named UserData.
          * @tparam C ImGui callback type to match.
+         * @tparam Storage Where to keep the stateful callback.
          * @tparam F Provided callable type.
          * @param callback The callback.
          * @return A pair containing the function pointer callback and the user data pointer storing the stateful callback.
         */
-        template<typename C, bool Cache, typename F>
+        template<typename C, CallbackStorage Storage, typename F>
             requires (!std::convertible_to<F, C>) && IsDataPointerStyleCallback<C>
         auto ThunkCallback(F&& callback)
         {
-            auto cb = [&] {
-                auto c = std::make_unique<Callback<F>>(std::move(callback));
-                if constexpr (Cache)
-                    return static_cast<Callback<F>*>(CacheCallback(std::move(c)));
-                else
-                    return std::move(c);
-                }();
+            auto cb = StoreCallback<Storage>(std::move(callback));
 
             using Data = std::tuple_element_t<0, typename CallbackTraits<C>::Arguments>;
             return std::make_pair([](Data data) {
-                return static_cast<Callback<F>*>(data->UserData)->callback(data);
+                return (*static_cast<F*>(data->UserData))(data);
                 }, std::move(cb));
         }
     }
 
+    /**
+     * Starts a new frame for the current ImGui context, call it right after ImGui::NewFrame().
+     * NGui state (frame storage, caches, persistent callbacks) belongs to the ImGui context and is freed with it, so independent contexts can build frames
+     * concurrently on separate threads without sharing any lock, provided GImGui is thread-local (see imconfig.h).
+    */
     void NewFrame();
 
+    struct FrameStats
+    {
+        size_t textSizeCacheHits = 0;
+        size_t textSizeCacheMisses = 0;
+        size_t elidedStylePushes = 0;
+    };
+
+    // Statistics gathered during the last completed frame of the current context.
+    const FrameStats& GetFrameStats();
+
+    // Drops all cached label measurements. Font atlas changes are detected automatically in NewFrame().
+    void InvalidateTextSizeCache();
+
     class FormatArgs
     {
         const char* value_;
@@ -293,7 +765,11 @@ namespace NGui
     public:
         template<typename... Args>
         FormatArgs(std::format_string<Args...> fmt, Args&& ...args)
-            : value_(Detail::CacheString(std::format(fmt, std::forward<Args>(args)...))) {}
+            : value_(Detail::FormatToFrame(fmt, std::forward<Args>(args)...).data()) {}
+
+        template<typename... Args>
+        FormatArgs(MemoizeT, Detail::MemoizedFormat<std::type_identity_t<Args>...> fmt, Args&& ...args)
+            : value_(Detail::FormatMemoized(fmt.location, fmt.fmt, std::forward<Args>(args)...).data()) {}
 
         FormatArgs(std::string_view val)
             : value_(Detail::CacheString(val)) {}
@@ -315,7 +791,11 @@ namespace NGui
     public:
         template<typename... Args>
         FormatArgsWithEnd(std::format_string<Args...> fmt, Args&& ...args)
-            : value_(Detail::CacheString(std::format(fmt, std::forward<Args>(args)...))) {}
+            : FormatArgsWithEnd(Detail::FormatToFrame(fmt, std::forward<Args>(args)...)) {}
+
+        template<typename... Args>
+        FormatArgsWithEnd(MemoizeT, Detail::MemoizedFormat<std::type_identity_t<Args>...> fmt, Args&& ...args)
+            : FormatArgsWithEnd(Detail::FormatMemoized(fmt.location, fmt.fmt, std::forward<Args>(args)...)) {}
 
         FormatArgsWithEnd(std::string_view val)
             : value_(val.data()), valueEnd_(val.data() + val.size()) {}
@@ -335,6 +815,114 @@ namespace NGui
 
     namespace Detail
     {
+        // Same lookup table as ImHashStr (standard CRC32, polynomial 0xEDB88320)
+        inline constexpr auto Crc32LookupTable = [] {
+            std::array<ImU32, 256> table{};
+            for (ImU32 i = 0; i < 256; ++i)
+            {
+                ImU32 crc = i;
+                for (int j = 0; j < 8; ++j)
+                    crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+                table[i] = crc;
+            }
+            return table;
+        }();
+    }
+
+    /**
+     * Label for literal strings which computes everything ImGui derives from the string at compile time: the visible text length and the ID hash, including "##" and "###" handling.
+     * Usage: NGui::Button(NGui::Label{ "OK" }) or, with NGui::Literals, NGui::Button("OK"_label).
+     *
+     * ImHashStr is a CRC32 of the string seeded by the parent ID. CRC32 is linear, so the hash for any seed is the hash for a zero seed XORed with a linear function of the seed.
+     * That function is stored as one column per seed bit, which reduces GetID() to at most 32 XORs regardless of the label length.
+    */
+    class Label
+    {
+        const char* text_;
+        ImU32 length_;
+        ImU32 visibleLength_;
+        ImU32 zeroSeedCrc_ = 0;
+        std::array<ImU32, 32> seedColumns_{};
+
+    public:
+        template<size_t N>
+        explicit consteval Label(const char(&text)[N])
+            : Label(text, N - 1) {}
+
+        explicit consteval Label(const char* text, size_t length)
+            : text_(text), length_(static_cast<ImU32>(length)), visibleLength_(static_cast<ImU32>(length))
+        {
+            // Text after "##" is hidden
+            for (size_t i = 0; i + 1 < length; ++i)
+            {
+                if (text[i] == '#' && text[i + 1] == '#')
+                {
+                    visibleLength_ = static_cast<ImU32>(i);
+                    break;
+                }
+            }
+
+            // "###" resets the hash to the seed, so only the part starting at the last occurrence is hashed
+            size_t hashStart = 0;
+            for (size_t i = 0; i + 2 < length; ++i)
+                if (text[i] == '#' && text[i + 1] == '#' && text[i + 2] == '#')
+                    hashStart = i;
+
+            const auto& lut = Detail::Crc32LookupTable;
+
+            for (size_t i = hashStart; i < length; ++i)
+                zeroSeedCrc_ = (zeroSeedCrc_ >> 8) ^ lut[(zeroSeedCrc_ & 0xFF) ^ static_cast<unsigned char>(text[i])];
+
+            for (int bit = 0; bit < 32; ++bit)
+            {
+                ImU32 crc = 1u << bit;
+                for (size_t i = hashStart; i < length; ++i)
+                    crc = (crc >> 8) ^ lut[crc & 0xFF];
+                seedColumns_[bit] = crc;
+            }
+        }
+
+        const char* GetValue() const { return text_; }
+        const char* GetValueEnd() const { return text_ + length_; }
+        const char* GetVisibleEnd() const { return text_ + visibleLength_; }
+
+        // Equivalent to ImHashStr(GetValue(), length, seed)
+        ImGuiID GetID(ImGuiID seed) const
+        {
+            ImU32 crc = zeroSeedCrc_;
+            for (ImU32 s = ~seed; s != 0; s &= s - 1)
+                crc ^= seedColumns_[std::countr_zero(s)];
+            return ~crc;
+        }
+    };
+
+    namespace Literals
+    {
+        consteval Label operator""_label(const char* text, size_t length)
+        {
+            return Label(text, length);
+        }
+    }
+
+    namespace Detail
+    {
+        // Equivalent to ImGui::GetID(label.GetValue())
+        inline ImGuiID GetID(const Label& label)
+        {
+            ImGuiWindow* window = ImGui::GetCurrentWindow();
+            const ImGuiID id = label.GetID(window->IDStack.back());
+            IM_ASSERT(id == window->GetID(label.GetValue(), label.GetValueEnd()));
+            return id;
+        }
+
+        /**
+         * Equivalent to ImGui::CalcTextSize(text, textEnd, true), but measurements are cached per font and font size until the font atlas changes.
+         * Label text has static storage, so it is looked up by address without reading it. Other text is looked up by its bytes,
+         * which only beats measuring it again from about 16 visible bytes on: shorter text is measured directly.
+        */
+        ImVec2 CalcLabelSize(const char* text, const char* textEnd = nullptr);
+        ImVec2 CalcLabelSize(const Label& label);
+
         inline const char* TryGetValue(const FormatArgs& fmt)
         {
             return fmt.GetValue();
@@ -355,6 +943,23 @@ namespace NGui
             return cstr;
         }
 
+        // Text of a label-like value, without copying it when it is already a string or view
+        template<typename T>
+        std::string_view GetLabelView(const T& value)
+        {
+            if constexpr (std::convertible_to<const T&, std::string_view>)
+                return value;
+            else
+                return TryGetValue(value);
+        }
+
+        // Maps an element of R to a label-like value (string, view, C string or FormatArgs).
+        template<typename P, typename R>
+        concept LabelProjection = std::invocable<P&, std::ranges::range_reference_t<R>> && requires(P& p, std::ranges::range_reference_t<R> e)
+        {
+            GetLabelView(std::invoke(p, e));
+        };
+
         template<typename E> requires std::is_enum_v<E>
         int Enum(E e)
         {
@@ -504,7 +1109,15 @@ namespace NGui
 
         [[nodiscard]] const auto& SizeConstraints(std::invocable<ImGuiSizeCallbackData*> auto&& callback) const
         {
-            auto&& [cb, data] = Detail::ThunkCallback<ImGuiSizeCallback, true>(std::move(callback));
+            auto&& [cb, data] = Detail::ThunkCallback<ImGuiSizeCallback, Detail::CallbackStorage::Frame>(std::move(callback));
+            ImGui::SetNextWindowSizeConstraints({}, {}, cb, data);
+
+            return static_cast<const T&>(*this);
+        }
+
+        [[nodiscard]] const auto& SizeConstraints(PersistentT, std::invocable<ImGuiSizeCallbackData*> auto&& callback) const
+        {
+            auto&& [cb, data] = Detail::ThunkCallback<ImGuiSizeCallback, Detail::CallbackStorage::Persistent>(std::move(callback));
             ImGui::SetNextWindowSizeConstraints({}, {}, cb, data);
 
             return static_cast<const T&>(*this);
@@ -597,6 +1210,9 @@ namespace NGui
         }
     } Region;
 
+    template<size_t N>
+    class StyleBlock;
+
     struct StyleVarX
     {
         ImGuiStyleVar_ v;
@@ -614,14 +1230,18 @@ namespace NGui
         {
             ImVec4 col;
 
-            BaseCol(const ImVec4& col) : col(col) {}
-            BaseCol(ImU32 col) : col(ImGui::ColorConvertU32ToFloat4(col)) {}
+            constexpr BaseCol(const ImVec4& col) : col(col) {}
+            constexpr BaseCol(ImU32 col)
+                : col(static_cast<float>((col >> IM_COL32_R_SHIFT) & 0xFF) * (1.f / 255.f), static_cast<float>((col >> IM_COL32_G_SHIFT) & 0xFF) * (1.f / 255.f),
+                      static_cast<float>((col >> IM_COL32_B_SHIFT) & 0xFF) * (1.f / 255.f), static_cast<float>((col >> IM_COL32_A_SHIFT) & 0xFF) * (1.f / 255.f)) {}
 
             friend class Style;
+            template<size_t N> friend class StyleBlock;
+            friend class Theme;
         };
 
     public:
-#define NGUI_DECLARE_STYLE_COL(Name_) struct Name_ : BaseCol { private: static constexpr ImGuiCol_ NGuiCol = ImGuiCol_##Name_; friend class Style; }
+#define NGUI_DECLARE_STYLE_COL(Name_) struct Name_ : BaseCol { private: static constexpr ImGuiCol_ NGuiCol = ImGuiCol_##Name_; friend class Style; template<size_t N> friend class StyleBlock; friend class Theme; }
 
         NGUI_DECLARE_STYLE_COL(Text);
         NGUI_DECLARE_STYLE_COL(TextDisabled);
@@ -695,11 +1315,13 @@ namespace NGui
         {
             T val;
 
-            BaseVar(float val) : val(val) {}
+            constexpr BaseVar(float val) : val(val) {}
 
         private:
             static constexpr ImGuiStyleVar_ NGuiStyleVar = V;
             friend class Style;
+            template<size_t N> friend class StyleBlock;
+            friend class Theme;
         };
 
         template<ImGuiStyleVar_ V>
@@ -707,15 +1329,17 @@ namespace NGui
         {
             ImVec2 val;
 
-            BaseVar(const ImVec2& val) : val(val) {}
-            BaseVar(float x, float y) : val(x, y) {}
+            constexpr BaseVar(const ImVec2& val) : val(val) {}
+            constexpr BaseVar(float x, float y) : val(x, y) {}
 
-            struct X : BaseVar<float, V> { using BaseVar<float, V>::BaseVar; private: static constexpr bool IsX = true; friend class Style; };
-            struct Y : BaseVar<float, V> { using BaseVar<float, V>::BaseVar; private: static constexpr bool IsY = true; friend class Style; };
+            struct X : BaseVar<float, V> { using BaseVar<float, V>::BaseVar; private: static constexpr bool IsX = true; friend class Style; template<size_t N> friend class StyleBlock; friend class Theme; };
+            struct Y : BaseVar<float, V> { using BaseVar<float, V>::BaseVar; private: static constexpr bool IsY = true; friend class Style; template<size_t N> friend class StyleBlock; friend class Theme; };
 
         private:
             static constexpr ImGuiStyleVar_ NGuiStyleVar = V;
             friend class Style;
+            template<size_t N> friend class StyleBlock;
+            friend class Theme;
         };
 
     public:
@@ -760,16 +1384,36 @@ namespace NGui
         static_assert(ImGuiStyleVar_COUNT == 34);
 
     private:
+        // Pushes which would leave the live style unchanged are skipped and only counted, so Pop() restores exactly what was pushed.
         struct State
         {
             short v = 0;
             short c = 0;
             short f = 0;
+            short elided = 0;
         };
 
         template<typename Var> requires requires() { { Var::NGuiStyleVar } -> std::convertible_to<ImGuiStyleVar_>; }
         void Push(const Var& v, State& s) const
         {
+            const auto* current = static_cast<const float*>(ImGui::GetStyleVarInfo(v.NGuiStyleVar)->GetVarPtr(&ImGui::GetStyle()));
+
+            bool unchanged;
+            if constexpr (requires() { Var::IsX; })
+                unchanged = current[0] == v.val;
+            else if constexpr (requires() { Var::IsY; })
+                unchanged = current[1] == v.val;
+            else if constexpr (std::is_same_v<decltype(Var::val), ImVec2>)
+                unchanged = current[0] == v.val.x && current[1] == v.val.y;
+            else
+                unchanged = current[0] == v.val;
+
+            if (unchanged)
+            {
+                ++s.elided;
+                return;
+            }
+
             ++s.v;
 
             if constexpr (requires() { Var::IsX; })
@@ -783,12 +1427,25 @@ namespace NGui
         template<typename Col> requires requires() { { Col::NGuiCol } -> std::convertible_to<ImGuiCol_>; }
         void Push(const Col& c, State& s) const
         {
+            const ImVec4& current = ImGui::GetStyle().Colors[c.NGuiCol];
+            if (current.x == c.col.x && current.y == c.col.y && current.z == c.col.z && current.w == c.col.w)
+            {
+                ++s.elided;
+                return;
+            }
+
             ++s.c;
             ImGui::PushStyleColor(c.NGuiCol, c.col);
         }
 
         void Push(ImFont* f, State& s) const
         {
+            if (f == ImGui::GetFont())
+            {
+                ++s.elided;
+                return;
+            }
+
             ++s.f;
             ImGui::PushFont(f);
         }
@@ -811,6 +1468,7 @@ namespace NGui
             if (s.v > 0) ImGui::PopStyleVar(s.v);
             if (s.c > 0) ImGui::PopStyleColor(s.c);
             while (s.f-- > 0) ImGui::PopFont();
+            if (s.elided > 0) Detail::RecordElidedStylePushes(s.elided);
         }
 
     public:
@@ -823,21 +1481,236 @@ namespace NGui
         }
     } Style;
 
-    static constexpr class TabStopT : protected Detail::InvokeBase
+    namespace Detail
     {
-    public:
-        void operator()(bool tabStop, auto&& body) const
-        {
-            InvokeStack<ImGui::PushTabStop, ImGui::PopTabStop>(std::forward<decltype(body)>(body), tabStop);
+        // Number of style floats overridden by a Style argument
+        template<typename T>
+        consteval size_t StyleFloatCount()
+        {
+            using Type = std::remove_cvref_t<T>;
+            if constexpr (requires() { sizeof(Type::col); })
+                return sizeof(Type::col) / sizeof(float);
+            else if constexpr (requires() { sizeof(Type::val); })
+                return sizeof(Type::val) / sizeof(float);
+            else if constexpr (requires() { std::tuple_size<Type>::value; })
+                return[]<std::size_t ...I>(std::index_sequence<I...>) {
+                    return (StyleFloatCount<std::tuple_element_t<I, Type>>() + ... + 0);
+                }(std::make_index_sequence<std::tuple_size_v<Type>>());
+            else
+                return 0;
         }
-    } TabStop;
+    }
 
-    static constexpr class ButtonRepeatT : protected Detail::InvokeBase
+    /**
+     * Set of style overrides built once from the same arguments as Style(), then applied to any number of bodies.
+     * Overrides are flattened to individual style floats sorted by their location in ImGuiStyle, with later arguments winning as they would when pushed,
+     * so applying the block is a single pass writing the new values while saving the old ones, and restoring it is a single pass writing them back.
+     * Unlike Style(), nothing goes through ImGui's style stacks: the body must not pop values it did not push itself.
+     *
+     * static const NGui::StyleBlock panel(NGui::Style::FramePadding{ 2.f, 2.f }, NGui::Color::FrameBg{ 0xFF202020 }, fontSmall);
+     * panel([&] { ... });
+    */
+    template<size_t N>
+    class StyleBlock
     {
     public:
-        void operator()(bool repeat, auto&& body) const
+        template<typename... Args>
+        explicit StyleBlock(const Args& ...args)
         {
-            InvokeStack<ImGui::PushButtonRepeat, ImGui::PopButtonRepeat>(std::forward<decltype(body)>(body), repeat);
+            (Add(args), ...);
+
+            std::stable_sort(overrides_.begin(), overrides_.begin() + count_, [](const Override& a, const Override& b) { return a.offset < b.offset; });
+
+            // Only keep the last override of each value, as successive pushes would
+            size_t unique = 0;
+            for (size_t i = 0; i < count_; ++i)
+                if (i + 1 == count_ || overrides_[i + 1].offset != overrides_[i].offset)
+                    overrides_[unique++] = overrides_[i];
+            count_ = unique;
+        }
+
+        void operator()(auto&& body) const
+        {
+            auto* style = reinterpret_cast<unsigned char*>(&ImGui::GetStyle());
+
+            std::array<float, N> backup;
+            for (size_t i = 0; i < count_; ++i)
+                backup[i] = std::exchange(*reinterpret_cast<float*>(style + overrides_[i].offset), overrides_[i].value);
+
+            if (font_)
+                ImGui::PushFont(font_);
+
+            body();
+
+            if (font_)
+                ImGui::PopFont();
+
+            for (size_t i = 0; i < count_; ++i)
+                *reinterpret_cast<float*>(style + overrides_[i].offset) = backup[i];
+        }
+
+    private:
+        struct Override
+        {
+            ImU32 offset;
+            float value;
+        };
+
+        void Add(ImU32 offset, float value)
+        {
+            overrides_[count_++] = { offset, value };
+        }
+
+        template<typename Var> requires requires() { { Var::NGuiStyleVar } -> std::convertible_to<ImGuiStyleVar_>; }
+        void Add(const Var& v)
+        {
+            const ImU32 offset = ImGui::GetStyleVarInfo(Var::NGuiStyleVar)->Offset;
+
+            if constexpr (requires() { Var::IsY; })
+                Add(offset + sizeof(float), v.val);
+            else if constexpr (std::is_same_v<decltype(Var::val), ImVec2>)
+            {
+                Add(offset, v.val.x);
+                Add(offset + sizeof(float), v.val.y);
+            }
+            else
+                Add(offset, v.val);
+        }
+
+        template<typename Col> requires requires() { { Col::NGuiCol } -> std::convertible_to<ImGuiCol_>; }
+        void Add(const Col& c)
+        {
+            const ImU32 offset = offsetof(ImGuiStyle, Colors) + Col::NGuiCol * sizeof(ImVec4);
+            Add(offset, c.col.x);
+            Add(offset + sizeof(float), c.col.y);
+            Add(offset + 2 * sizeof(float), c.col.z);
+            Add(offset + 3 * sizeof(float), c.col.w);
+        }
+
+        void Add(ImFont* f)
+        {
+            font_ = f;
+        }
+
+        template<typename ...Types>
+        void Add(const std::tuple<Types...>& tup)
+        {
+            std::apply([this](const auto& ...args) { (Add(args), ...); }, tup);
+        }
+
+        std::array<Override, N> overrides_{};
+        size_t count_ = 0;
+        ImFont* font_ = nullptr;
+    };
+
+    template<typename... Args>
+    StyleBlock(const Args& ...) -> StyleBlock<(Detail::StyleFloatCount<Args>() + ... + 0)>;
+
+    static constexpr class Theme : protected Detail::InvokeBase
+    {
+    public:
+        /**
+         * Complete or partial set of style values, built at compile time from the same Style::X and Color::X arguments as Style().
+         * Values not set by the definition are left untouched when it is applied.
+         *
+         * constexpr NGui::Theme::Definition compact{ NGui::Style::FramePadding{ 2.f, 2.f }, NGui::Style::ItemSpacing{ 4.f, 2.f } };
+         * constexpr auto compactRed = compact.With(NGui::Color::Text{ 0xFF0000FF });
+        */
+        class Definition
+        {
+        public:
+            constexpr Definition() = default;
+
+            template<typename... Args>
+            constexpr explicit Definition(const Args& ...args)
+            {
+                (Set(args), ...);
+            }
+
+            template<typename... Args>
+            [[nodiscard]] constexpr Definition With(const Args& ...args) const
+            {
+                Definition def = *this;
+                (def.Set(args), ...);
+                return def;
+            }
+
+            // Captures every value of an existing style, e.g. one prepared with ImGui::StyleColorsDark().
+            [[nodiscard]] static Definition Capture(const ImGuiStyle& style);
+
+        private:
+            template<typename Var> requires requires() { { Var::NGuiStyleVar } -> std::convertible_to<ImGuiStyleVar_>; }
+            constexpr void Set(const Var& v)
+            {
+                const ImU64 bit = ImU64(1) << Var::NGuiStyleVar;
+                ImVec2& value = vars_[Var::NGuiStyleVar];
+
+                if constexpr (requires() { Var::IsY; })
+                {
+                    value.y = v.val;
+                    varMaskY_ |= bit;
+                }
+                else if constexpr (std::is_same_v<decltype(Var::val), ImVec2>)
+                {
+                    value = v.val;
+                    varMaskX_ |= bit;
+                    varMaskY_ |= bit;
+                }
+                else
+                {
+                    value.x = v.val;
+                    varMaskX_ |= bit;
+                }
+            }
+
+            template<typename Col> requires requires() { { Col::NGuiCol } -> std::convertible_to<ImGuiCol_>; }
+            constexpr void Set(const Col& c)
+            {
+                colors_[Col::NGuiCol] = c.col;
+                colorMask_ |= ImU64(1) << Col::NGuiCol;
+            }
+
+            // Float vars only use x
+            std::array<ImVec2, ImGuiStyleVar_COUNT> vars_{};
+            std::array<ImVec4, ImGuiCol_COUNT> colors_{};
+            ImU64 varMaskX_ = 0;
+            ImU64 varMaskY_ = 0;
+            ImU64 colorMask_ = 0;
+
+            friend class Theme;
+        };
+
+        // Replaces the values set by the definition in the current context's style, a single copy for fully specified colors.
+        void Apply(const Definition& def) const;
+
+        // Applies the definition for the duration of the body only. The whole style is backed up and restored as one block, including any change made by the body.
+        void operator()(const Definition& def, auto&& body) const
+        {
+            ImGuiStyle& style = ImGui::GetStyle();
+            const ImGuiStyle backup = style;
+
+            Apply(def);
+            body();
+
+            style = backup;
+        }
+    } Theme;
+
+    static constexpr class TabStopT : protected Detail::InvokeBase
+    {
+    public:
+        void operator()(bool tabStop, auto&& body) const
+        {
+            InvokeStack<ImGui::PushTabStop, ImGui::PopTabStop>(std::forward<decltype(body)>(body), tabStop);
+        }
+    } TabStop;
+
+    static constexpr class ButtonRepeatT : protected Detail::InvokeBase
+    {
+    public:
+        void operator()(bool repeat, auto&& body) const
+        {
+            InvokeStack<ImGui::PushButtonRepeat, ImGui::PopButtonRepeat>(std::forward<decltype(body)>(body), repeat);
         }
     } ButtonRepeat;
 
@@ -929,6 +1802,11 @@ namespace NGui
             InvokeStack<static_cast<void(*)(const char*, const char*)>(ImGui::PushID), ImGui::PopID>(std::forward<decltype(body)>(body), fmt.GetValue());
         }
 
+        void operator()(const Label& label, auto&& body) const
+        {
+            InvokeStack<ImGui::PushOverrideID, ImGui::PopID>(std::forward<decltype(body)>(body), Detail::GetID(label));
+        }
+
         void operator()(const void* id, auto&& body) const
         {
             InvokeStack<static_cast<void(*)(const void*)>(ImGui::PushID), ImGui::PopID>(std::forward<decltype(body)>(body), id);
@@ -947,6 +1825,14 @@ namespace NGui
             return ImGui::Button(fmt.GetValue(), size);
         }
 
+        bool operator()(const Label& label, const ImVec2& size = {}) const
+        {
+            if (ImGui::GetCurrentWindow()->SkipItems)
+                return false;
+
+            return ImGuiExt::ButtonEx(Detail::GetID(label), label.GetValue(), label.GetVisibleEnd(), Detail::CalcLabelSize(label), size);
+        }
+
         bool Small(FormatArgs fmt) const
         {
             return ImGui::SmallButton(fmt.GetValue());
@@ -976,6 +1862,14 @@ namespace NGui
             return ImGui::Checkbox(fmt.GetValue(), &v);
         }
 
+        bool operator()(const Label& label, bool& v) const
+        {
+            if (ImGui::GetCurrentWindow()->SkipItems)
+                return false;
+
+            return ImGuiExt::Checkbox(Detail::GetID(label), label.GetValue(), label.GetVisibleEnd(), Detail::CalcLabelSize(label), &v);
+        }
+
         template<std::integral T>
         bool Flags(FormatArgs fmt, T& value, T fullMask) const
         {
@@ -1270,7 +2164,7 @@ namespace NGui
         {
             if (params.size)
                 params.flags |= ImGuiInputTextFlags_Multiline;
-            auto&& [cb, data] = Detail::ThunkCallback<ImGuiInputTextCallback, false>(std::move(callback));
+            auto&& [cb, data] = Detail::ThunkCallback<ImGuiInputTextCallback, Detail::CallbackStorage::Local>(std::move(callback));
             return ImGui::InputTextEx(fmt.GetValue(), params.hint ? params.hint->GetValue() : nullptr, buf.data(), static_cast<int>(buf.size()), params.size ? *params.size : ImVec2(0, 0), params.flags, cb, data.get());
         }
 
@@ -1295,7 +2189,7 @@ namespace NGui
             params.flags |= ImGuiInputTextFlags_CallbackResize;
             if (params.size)
                 params.flags |= ImGuiInputTextFlags_Multiline;
-            auto&& [cb, data] = Detail::ThunkCallback<ImGuiInputTextCallback, false>(std::move(callback));
+            auto&& [cb, data] = Detail::ThunkCallback<ImGuiInputTextCallback, Detail::CallbackStorage::Local>(std::move(callback));
             StringResizeCallbackData wrapData{ str, cb, data.get() };
             return ImGui::InputTextEx(fmt.GetValue(), params.hint ? params.hint->GetValue() : nullptr, str.data(), static_cast<int>(str.capacity() + 1), params.size ? *params.size : ImVec2(0, 0), params.flags, StringResizeCallback, &wrapData);
         }
@@ -1404,6 +2298,30 @@ namespace NGui
             InvokeBlock<static_cast<bool(*)(const char*, const char*, ...)>(ImGui::TreeNode), ImGui::TreePop, false>(id, std::forward<decltype(body)>(body), label.GetValue());
         }
 
+        void operator()(const Label& label, auto&& body) const
+        {
+            if (ImGui::GetCurrentWindow()->SkipItems)
+                return;
+
+            if (ImGui::TreeNodeBehavior(Detail::GetID(label), ImGuiTreeNodeFlags_None, label.GetValue(), label.GetVisibleEnd()))
+            {
+                body();
+                ImGui::TreePop();
+            }
+        }
+
+        void operator()(const Label& id, FormatArgsWithEnd label, auto&& body) const
+        {
+            if (ImGui::GetCurrentWindow()->SkipItems)
+                return;
+
+            if (ImGui::TreeNodeBehavior(Detail::GetID(id), ImGuiTreeNodeFlags_None, label.GetValue(), label.GetValueEnd()))
+            {
+                body();
+                ImGui::TreePop();
+            }
+        }
+
         const Opener<true> Opened{ *this };
         const Opener<false> Closed{ *this };
 
@@ -1421,11 +2339,26 @@ namespace NGui
         {
             InvokeBlock<static_cast<bool(*)(const char*, ImGuiTreeNodeFlags)>(ImGui::CollapsingHeader), [] {}, false>(label, std::forward<decltype(body)>(body), params.flags);
         }
+
+        void operator()(const Label& label, Params&& params, auto&& body) const
+        {
+            if (ImGui::GetCurrentWindow()->SkipItems)
+                return;
+
+            if (ImGui::TreeNodeBehavior(Detail::GetID(label), params.flags | ImGuiTreeNodeFlags_CollapsingHeader, label.GetValue(), label.GetVisibleEnd()))
+                body();
+        }
+
+        void operator()(const Label& label, auto&& body) const
+        {
+            operator()(label, {}, std::forward<decltype(body)>(body));
+        }
     } CollapsingHeader;
 
     static constexpr class ProgressBarT
     {
-        void operator()(float fraction, const ImVec2& size = ImVec2(-FLT_MIN, 0), FormatArgs overlay = nullptr)
+    public:
+        void operator()(float fraction, const ImVec2& size = ImVec2(-FLT_MIN, 0), FormatArgs overlay = nullptr) const
         {
             ImGui::ProgressBar(fraction, size, overlay.GetValue());
         }
@@ -1433,6 +2366,7 @@ namespace NGui
 
     static constexpr class ImageT
     {
+    public:
         struct Params
         {
             ImVec2 uv0 { 0, 0 };
@@ -1441,129 +2375,544 @@ namespace NGui
             ImVec4 borderColor{  0, 0, 0, 0 };
         };
 
-        void operator()(ImTextureID textureId, const ImVec2& size, const Params& params)
+        void operator()(ImTextureID textureId, const ImVec2& size, const Params& params = {}) const
         {
             ImGui::Image(textureId, size, params.uv0, params.uv1, params.tintColor, params.borderColor);
         }
 
-        bool Button(FormatArgs id, ImTextureID textureId, const ImVec2& size, const Params& params)
+        bool Button(FormatArgs id, ImTextureID textureId, const ImVec2& size, const Params& params = {}) const
         {
             return ImGui::ImageButton(id.GetValue(), textureId, size, params.uv0, params.uv1, params.tintColor, params.borderColor);
         }
     } Image;
 
-    static constexpr class ComboBoxT : protected Detail::InvokeBase
+    namespace Detail
     {
-    public:
-        void operator()(FormatArgs label, FormatArgs preview, ImGuiComboFlags_ flags, auto&& body) const
+        /**
+         * Submits a selectable per row, through a list clipper so only the rows visible in the current window are formatted and submitted.
+         * When the window appears, the selected row is included, focused and scrolled into view.
+         * Labels are passed to ImGui with their length and identified by index, so views and other unterminated labels are never copied.
+         * @param projection Maps an element to its label.
+         * @param elementAt Maps a row to the index of the element it shows.
+        */
+        template<typename Index>
+        bool ClippedSelectables(Index& index, Detail::SizedRandomAccessRange auto&& elements, auto&& projection, ImGuiSelectableFlags_ selFlags, int rowCount, int selectedRow, auto&& elementAt,
+            bool focusSelected = true)
         {
-            InvokeBlock<ImGui::BeginCombo, ImGui::EndCombo, false>(label, std::forward<decltype(body)>(body), preview.GetValue(), flags);
-        }
+            const bool appearing = ImGui::IsWindowAppearing();
+            bool selected = false;
 
-        void operator()(FormatArgs label, FormatArgs preview, auto&& body) const
-        {
-            operator()(label, preview, ImGuiComboFlags_None, std::forward<decltype(body)>(body));
-        }
+            ImGuiListClipper clipper;
+            clipper.Begin(rowCount);
+            if (appearing && selectedRow >= 0)
+                clipper.IncludeItemByIndex(selectedRow);
 
-        bool operator()(FormatArgs label, auto& index, std::ranges::random_access_range auto&& elements, ImGuiComboFlags_ flags = ImGuiComboFlags_None, ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None) const
-            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<decltype(elements)>>>
-        {
-            bool selected = false;
-            std::decay_t<decltype(index)> i = 0;
-            operator()(label, Detail::TryGetValue(elements[index]), flags, [&] {
-                for (const auto& opt : elements)
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
                 {
-                    if (ImGui::Selectable(Detail::TryGetValue(opt), i == index, selFlags))
+                    const int i = elementAt(row);
+                    const bool isSelected = std::cmp_equal(i, index);
+                    decltype(auto) value = std::invoke(projection, elements[i]);
+                    const std::string_view text = GetLabelView(value);
+                    if (ImGuiExt::Selectable(i, text.data(), text.data() + text.size(), isSelected, selFlags))
                     {
-                        index = i;
+                        index = static_cast<Index>(i);
                         selected = true;
                     }
-                    ++i;
+
+                    if (isSelected && appearing)
+                    {
+                        if (focusSelected)
+                            ImGui::SetItemDefaultFocus();
+                        ImGui::SetScrollHereY();
+                    }
                 }
-            });
+            }
 
             return selected;
         }
 
-    } ComboBox;
+        template<typename Index>
+        bool ClippedSelectables(Index& index, Detail::SizedRandomAccessRange auto&& elements, auto&& projection, ImGuiSelectableFlags_ selFlags)
+        {
+            const int count = static_cast<int>(std::ranges::size(elements));
+            const int selectedRow = std::cmp_greater_equal(index, 0) && std::cmp_less(index, count) ? static_cast<int>(index) : -1;
 
-    template<typename T> constexpr size_t VectorLength = std::extent_v<T>;
+            return ClippedSelectables(index, elements, projection, selFlags, count, selectedRow, [](int row) { return row; });
+        }
 
-    inline float* GetPointer(float* v)
-    {
-        return v;
-    }
+        /**
+         * Case-insensitive (ASCII) substring index over a list of labels, ignoring anything after "##".
+         * Labels are copied lowercased once, and each of their distinct 1, 2 and 3 character substrings ("grams") maps to the sorted list of labels containing it,
+         * stored as one flat array of postings. Filters of up to 3 characters are answered by a single postings list, longer ones intersect the postings of their
+         * trigrams and only compare the remaining candidates.
+        */
+        class SearchIndex
+        {
+        public:
+            // Labels copied per call to Update, so that indexing a long list is spread over several frames
+            static constexpr size_t CopyBudget = 1 << 15;
+            // Labels totalling at most this many characters are indexed right away, larger lists on a background thread
+            static constexpr size_t SyncIndexSize = 1 << 18;
+
+            // Starts over with count labels, which Update then copies. Cancels and joins any background build of the previous labels.
+            void Reset(size_t count);
+
+            /**
+             * Copies up to CopyBudget more labels, getLabel(i) returning the i-th label as any value accepted by GetLabelView.
+             * Once every label is copied, they are indexed; until the index of a large list is built, queries scan the labels copied so far.
+             * @return Whether the searchable labels or the index changed, so previous results may be stale.
+            */
+            bool Update(auto&& getLabel)
+            {
+                bool changed = PollGrams();
+                if (labels_->ends.size() < count_)
+                {
+                    for (size_t i = labels_->ends.size(), end = std::min(count_, i + CopyBudget); i < end; ++i)
+                        AppendLabel(GetLabelView(getLabel(i)));
+                    if (labels_->ends.size() == count_)
+                        StartGrams();
+                    changed = true;
+                }
+                return changed;
+            }
 
-    template<> constexpr size_t VectorLength<ImVec2> = 2;
-    inline float* GetPointer(ImVec2& v)
-    {
-        return &v.x;
-    }
+            // Replaces results with the indices of every label containing filter, in ascending order.
+            void Query(std::string_view filter, std::vector<int>& results) const;
 
-    template<> constexpr size_t VectorLength<ImVec4> = 4;
-    inline float* GetPointer(ImVec4& v)
-    {
-        return &v.x;
-    }
+        private:
+            struct Labels
+            {
+                std::string text;          // Lowercased labels, back to back
+                std::vector<ImU32> ends;   // End of each label in text
+            };
 
-    namespace Detail
-    {
-        template<typename T, size_t N>
-        concept VectorOfLength = (VectorLength<T> == N) && requires(T t)
+            struct Grams
+            {
+                std::vector<ImU32> keys;     // Sorted distinct grams, as packed by PackGram
+                std::vector<ImU32> starts;   // Postings of keys[k] are postings[starts[k], starts[k + 1])
+                std::vector<ImU32> postings;
+            };
+
+            // Result of the background build, dropped with the index if the labels change before it completes
+            struct PendingGrams
+            {
+                std::mutex mutex;
+                std::shared_ptr<const Grams> result;
+            };
+
+            void AppendLabel(std::string_view label);
+            void StartGrams();
+            bool PollGrams();
+            static std::optional<Grams> BuildGrams(const Labels& labels, std::stop_token stop);
+            std::span<const ImU32> FindPostings(std::string_view gram) const;
+            std::string_view GetText(size_t i) const;
+
+            size_t count_ = 0;
+            // Only modified while copying, then shared read-only with the background build
+            std::shared_ptr<Labels> labels_ = std::make_shared<Labels>();
+            std::shared_ptr<const Grams> grams_;
+            std::shared_ptr<PendingGrams> pending_;
+            // Declared last so that it is stopped and joined before the rest of the index is destroyed
+            std::jthread builder_;
+        };
+
+        // Filter text, search index and matching elements of a filtered ComboBox or ListBox.
+        class FilteredList
         {
-            GetPointer(t);
+        public:
+            std::string filter;
+            std::vector<int> results;
+
+            // Restarts the index if the elements' count or version changed, continues building it, then refreshes the results if needed.
+            void Update(Detail::SizedRandomAccessRange auto&& elements, auto&& projection, size_t version)
+            {
+                const size_t count = std::ranges::size(elements);
+                if (!built_ || count != indexedCount_ || version != indexedVersion_)
+                {
+                    index_.Reset(count);
+                    built_ = true;
+                    indexedCount_ = count;
+                    indexedVersion_ = version;
+                }
+
+                if (index_.Update([&](size_t i) -> decltype(auto) { return std::invoke(projection, elements[i]); }))
+                    resultsValid_ = false;
+
+                if (!resultsValid_ || query_ != filter)
+                {
+                    index_.Query(filter, results);
+                    query_ = filter;
+                    resultsValid_ = true;
+                }
+            }
+
+        private:
+            SearchIndex index_;
+            std::string query_;
+            size_t indexedCount_ = 0;
+            size_t indexedVersion_ = 0;
+            bool built_ = false;
+            bool resultsValid_ = false;
         };
+
+        template<typename Index>
+        bool FilteredSelectables(Index& index, Detail::SizedRandomAccessRange auto&& elements, auto&& projection, ImGuiSelectableFlags_ selFlags, const std::vector<int>& rows,
+            bool focusSelected = true)
+        {
+            int selectedRow = -1;
+            if (std::cmp_greater_equal(index, 0) && std::cmp_less(index, std::numeric_limits<int>::max()))
+            {
+                const auto it = std::ranges::lower_bound(rows, static_cast<int>(index));
+                if (it != rows.end() && *it == static_cast<int>(index))
+                    selectedRow = static_cast<int>(it - rows.begin());
+            }
+
+            return ClippedSelectables(index, elements, projection, selFlags, static_cast<int>(rows.size()), selectedRow, [&](int row) { return rows[row]; }, focusSelected);
+        }
     }
 
-    static constexpr class ColorWidgetT
+    static constexpr class ComboBoxT : protected Detail::InvokeBase
     {
     public:
-        template<Detail::VectorOfLength<3> T>
-        bool operator()(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
-        {
-            return ImGui::ColorEdit3(label.GetValue(), GetPointer(vec), flags);
-        }
-        template<Detail::VectorOfLength<4> T>
-        bool operator()(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+        void operator()(FormatArgs label, FormatArgs preview, ImGuiComboFlags_ flags, auto&& body) const
         {
-            return ImGui::ColorEdit4(label.GetValue(), GetPointer(vec), flags);
+            InvokeBlock<ImGui::BeginCombo, ImGui::EndCombo, false>(label, std::forward<decltype(body)>(body), preview.GetValue(), flags);
         }
 
-        template<Detail::VectorOfLength<3> T>
-        bool Picker(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+        void operator()(FormatArgs label, FormatArgs preview, auto&& body) const
         {
-            return ImGui::ColorPicker3(label.GetValue(), GetPointer(vec), flags);
+            operator()(label, preview, ImGuiComboFlags_None, std::forward<decltype(body)>(body));
         }
-        template<Detail::VectorOfLength<4> T>
-        bool Picker(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+
+        bool operator()(FormatArgs label, auto& index, Detail::SizedRandomAccessRange auto&& elements, ImGuiComboFlags_ flags = ImGuiComboFlags_None, ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<decltype(elements)>>>
         {
-            return ImGui::ColorPicker4(label.GetValue(), GetPointer(vec), flags);
+            return operator()(label, index, elements, std::identity{}, flags, selFlags);
         }
 
-        bool Button(FormatArgs label, const ImVec4& col, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None, const ImVec2& size = { 0, 0 }) const
+        // Same as above, showing projection(element) for each element, e.g. a member pointer or a function returning an enum's name.
+        template<Detail::SizedRandomAccessRange R>
+        bool operator()(FormatArgs label, auto& index, R&& elements, Detail::LabelProjection<R> auto&& projection, ImGuiComboFlags_ flags = ImGuiComboFlags_None, ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<R>>>
         {
-            return ImGui::ColorButton(label.GetValue(), col, flags, size);
+            bool selected = false;
+            operator()(label, Detail::TryGetValue(std::invoke(projection, elements[index])), flags, [&] {
+                selected = Detail::ClippedSelectables(index, elements, projection, selFlags);
+            });
+
+            return selected;
         }
-    } ColorWidget;
 
-    static constexpr class SelectableT
-    {
-    public:
-        struct Params
+        struct FilterParams
         {
-            ImGuiSelectableFlags_ flags = ImGuiSelectableFlags_None;
-            ImVec2 size{ 0, 0 };
+            ImGuiComboFlags_ flags = ImGuiComboFlags_None;
+            ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None;
+            size_t version = 0; // Change when the elements change without their count changing, to rebuild the search index
+            const char* hint = "Filter";
         };
 
-        bool operator()(FormatArgs label, bool selected = false, const Params& params = {}) const
+        // Combo box with a filter field narrowing the choices to the elements containing the typed text, through an index built when the popup opens.
+        bool Filtered(FormatArgs label, auto& index, Detail::SizedRandomAccessRange auto&& elements, const FilterParams& params = {}) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<decltype(elements)>>>
         {
-            return ImGui::Selectable(label.GetValue(), selected, params.flags, params.size);
+            return Filtered(label, index, elements, std::identity{}, params);
         }
 
-        bool operator()(FormatArgs label, bool& selected, const Params& params = {}) const
+        template<Detail::SizedRandomAccessRange R>
+        bool Filtered(FormatArgs label, auto& index, R&& elements, Detail::LabelProjection<R> auto&& projection, const FilterParams& params = {}) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<R>>>
+        {
+            auto& list = Detail::GetWidgetState<Detail::FilteredList>(ImGui::GetID(label.GetValue()));
+
+            bool selected = false;
+            operator()(label, Detail::TryGetValue(std::invoke(projection, elements[index])), params.flags, [&] {
+                if (ImGui::IsWindowAppearing())
+                    ImGui::SetKeyboardFocusHere();
+                ImGui::SetNextItemWidth(-FLT_MIN);
+                ImGui::InputTextWithHint("##filter", params.hint, &list.filter);
+
+                list.Update(elements, projection, params.version);
+                // The filter field has the keyboard focus, the current element is only scrolled into view
+                selected = Detail::FilteredSelectables(index, elements, projection, params.selFlags, list.results, false);
+            });
+
+            return selected;
+        }
+
+    } ComboBox;
+
+    /**
+     * Combo box listing the enumerators of value's enum, e.g. NGui::EnumCombo("Mode", mode).
+     * Names come from Detail::EnumEntries<E>, built at compile time from the enumerators (see EnumRange and EnumNames), so nothing is formatted,
+     * allocated or searched for per frame.
+    */
+    static constexpr class EnumComboT
+    {
+    public:
+        template<typename E> requires std::is_enum_v<E>
+        bool operator()(FormatArgs label, E& value, ImGuiComboFlags_ flags = ImGuiComboFlags_None) const
+        {
+            constexpr auto& entries = Detail::EnumEntries<E>;
+            const int current = Detail::FindEnumEntry(value);
+            if (!ImGui::BeginCombo(label.GetValue(), current >= 0 ? entries[current].name : "", flags))
+                return false;
+
+            bool changed = false;
+            for (int i = 0; i < static_cast<int>(entries.size()); ++i)
+            {
+                ImGui::PushID(i);
+                if (ImGui::Selectable(entries[i].name, i == current))
+                {
+                    value = entries[i].value;
+                    changed = true;
+                }
+                if (i == current && ImGui::IsWindowAppearing())
+                    ImGui::SetItemDefaultFocus();
+                ImGui::PopID();
+            }
+
+            ImGui::EndCombo();
+            return changed;
+        }
+    } EnumCombo;
+
+    // One radio button per enumerator of value's enum, scoped by id.
+    static constexpr class EnumRadioT
+    {
+    public:
+        template<typename E> requires std::is_enum_v<E>
+        bool operator()(FormatArgs id, E& value, bool sameLine = false) const
+        {
+            constexpr auto& entries = Detail::EnumEntries<E>;
+            const int current = Detail::FindEnumEntry(value);
+
+            bool changed = false;
+            ImGui::PushID(id.GetValue());
+            for (int i = 0; i < static_cast<int>(entries.size()); ++i)
+            {
+                if (sameLine && i > 0)
+                    ImGui::SameLine();
+
+                ImGui::PushID(i);
+                if (ImGui::RadioButton(entries[i].name, i == current) && i != current)
+                {
+                    value = entries[i].value;
+                    changed = true;
+                }
+                ImGui::PopID();
+            }
+            ImGui::PopID();
+
+            return changed;
+        }
+    } EnumRadio;
+
+    // One checkbox per flag of a flag enum (see EnableFlagOperators), scoped by id.
+    static constexpr class EnumFlagsT
+    {
+    public:
+        template<typename E> requires EnableFlagOperators<E>
+        bool operator()(FormatArgs id, E& value, bool sameLine = false) const
+        {
+            constexpr auto& entries = Detail::EnumEntries<E>;
+
+            bool changed = false, first = true;
+            ImGui::PushID(id.GetValue());
+            for (int i = 0; i < static_cast<int>(entries.size()); ++i)
+            {
+                const auto flag = ToUnderlying(entries[i].value);
+                if (flag == 0)
+                    continue;
+                if (sameLine && !first)
+                    ImGui::SameLine();
+                first = false;
+
+                bool set = (ToUnderlying(value) & flag) == flag;
+                ImGui::PushID(i);
+                if (ImGui::Checkbox(entries[i].name, &set))
+                {
+                    value = static_cast<E>(set ? ToUnderlying(value) | flag : ToUnderlying(value) & ~flag);
+                    changed = true;
+                }
+                ImGui::PopID();
+            }
+            ImGui::PopID();
+
+            return changed;
+        }
+    } EnumFlags;
+
+    template<typename T> constexpr size_t VectorLength = std::extent_v<T>;
+
+    inline float* GetPointer(float* v)
+    {
+        return v;
+    }
+
+    template<> constexpr size_t VectorLength<ImVec2> = 2;
+    inline float* GetPointer(ImVec2& v)
+    {
+        return &v.x;
+    }
+
+    template<> constexpr size_t VectorLength<ImVec4> = 4;
+    inline float* GetPointer(ImVec4& v)
+    {
+        return &v.x;
+    }
+
+    namespace Detail
+    {
+        template<typename T, size_t N>
+        concept VectorOfLength = (VectorLength<T> == N) && requires(T t)
+        {
+            GetPointer(t);
+        };
+    }
+
+    static constexpr class ColorWidgetT
+    {
+    public:
+        template<Detail::VectorOfLength<3> T>
+        bool operator()(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+        {
+            return ImGui::ColorEdit3(label.GetValue(), GetPointer(vec), flags);
+        }
+        template<Detail::VectorOfLength<4> T>
+        bool operator()(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+        {
+            return ImGui::ColorEdit4(label.GetValue(), GetPointer(vec), flags);
+        }
+
+        template<Detail::VectorOfLength<3> T>
+        bool Picker(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+        {
+            return ImGui::ColorPicker3(label.GetValue(), GetPointer(vec), flags);
+        }
+        template<Detail::VectorOfLength<4> T>
+        bool Picker(FormatArgs label, T& vec, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None) const
+        {
+            return ImGui::ColorPicker4(label.GetValue(), GetPointer(vec), flags);
+        }
+
+        bool Button(FormatArgs label, const ImVec4& col, ImGuiColorEditFlags_ flags = ImGuiColorEditFlags_None, const ImVec2& size = { 0, 0 }) const
+        {
+            return ImGui::ColorButton(label.GetValue(), col, flags, size);
+        }
+    } ColorWidget;
+
+    /**
+     * Set of indices, e.g. the selected rows of a list, stored as pages of PageBits indices which are each empty, full or hold a bitset.
+     * Range operations only touch the bitsets of the pages at both ends, so selecting or clearing millions of indices costs one step per page.
+    */
+    class IndexSet
+    {
+    public:
+        static constexpr size_t PageBits = 4096;
+
+        [[nodiscard]] bool Contains(size_t index) const
+        {
+            const size_t page = index / PageBits;
+            if (page >= pages_.size() || pages_[page].count == 0)
+                return false;
+
+            const auto& bits = pages_[page].bits;
+            return !bits || (bits[index % PageBits / 64] >> (index % 64) & 1) != 0;
+        }
+
+        void Set(size_t index, bool present) { SetRange(index, index + 1, present); }
+        // Adds or removes every index in [first, last)
+        void SetRange(size_t first, size_t last, bool present);
+        void Clear();
+
+        [[nodiscard]] size_t Size() const { return size_; }
+        [[nodiscard]] bool Empty() const { return size_ == 0; }
+
+        // Calls f for every index, in ascending order
+        template<std::invocable<size_t> F>
+        void ForEach(F&& f) const
+        {
+            for (size_t page = 0; page < pages_.size(); ++page)
+            {
+                const size_t base = page * PageBits;
+                if (pages_[page].count == 0)
+                    continue;
+                if (!pages_[page].bits)
+                {
+                    for (size_t i = 0; i < PageBits; ++i)
+                        f(base + i);
+                    continue;
+                }
+
+                for (size_t word = 0; word < PageBits / 64; ++word)
+                    for (ImU64 bits = pages_[page].bits[word]; bits != 0; bits &= bits - 1)
+                        f(base + word * 64 + std::countr_zero(bits));
+            }
+        }
+
+        // Applies the requests of ImGui's multi-select API, the items' selection user data being their index. Returns true if there were any.
+        bool ApplyRequests(const ImGuiMultiSelectIO& io, size_t itemCount);
+
+    private:
+        struct Page
+        {
+            ImU32 count = 0;                 // PageBits when full
+            std::unique_ptr<ImU64[]> bits;   // Only for pages which are neither empty nor full
+        };
+
+        std::vector<Page> pages_;
+        size_t size_ = 0;
+    };
+
+    static constexpr class MultiSelectT
+    {
+    public:
+        static constexpr ImGuiMultiSelectFlags_ DefaultFlags = ImGuiMultiSelectFlags_ClearOnEscape | ImGuiMultiSelectFlags_BoxSelect1d;
+
+        /**
+         * Scope in which items submitted after ImGui::SetNextItemSelectionUserData(index) can be selected together (click, ctrl/shift-click, box
+         * selection, keyboard), ImGui's requests being applied to selection as range operations.
+         * body receives the index of the item a shift-click range starts from, to pass to ImGuiListClipper::IncludeItemByIndex() when it is not -1.
+         * Returns true if the selection changed.
+        */
+        bool operator()(IndexSet& selection, size_t itemCount, auto&& body, ImGuiMultiSelectFlags_ flags = DefaultFlags) const
+        {
+            ImGuiMultiSelectIO* io = ImGui::BeginMultiSelect(flags, static_cast<int>(std::min<size_t>(selection.Size(), INT_MAX)), static_cast<int>(itemCount));
+            bool changed = selection.ApplyRequests(*io, itemCount);
+            std::invoke(body, static_cast<int>(io->RangeSrcItem));
+            io = ImGui::EndMultiSelect();
+            changed |= selection.ApplyRequests(*io, itemCount);
+            return changed;
+        }
+    } MultiSelect;
+
+    static constexpr class SelectableT
+    {
+    public:
+        struct Params
+        {
+            ImGuiSelectableFlags_ flags = ImGuiSelectableFlags_None;
+            ImVec2 size{ 0, 0 };
+        };
+
+        bool operator()(FormatArgs label, bool selected = false, const Params& params = {}) const
+        {
+            return ImGui::Selectable(label.GetValue(), selected, params.flags, params.size);
+        }
+
+        bool operator()(FormatArgs label, bool& selected, const Params& params = {}) const
         {
             return ImGui::Selectable(label.GetValue(), &selected, params.flags, params.size);
         }
+
+        // Item of an NGui::MultiSelect scope, selected while selection contains index
+        bool operator()(FormatArgs label, const IndexSet& selection, size_t index, const Params& params = {}) const
+        {
+            ImGui::SetNextItemSelectionUserData(static_cast<ImGuiSelectionUserData>(index));
+            return ImGui::Selectable(label.GetValue(), selection.Contains(index), params.flags, params.size);
+        }
     } Selectable;
 
     static constexpr class ListBoxT : protected Detail::InvokeBase
@@ -1579,28 +2928,921 @@ namespace NGui
             InvokeBlock<ImGui::BeginListBox, ImGui::EndListBox, false>(label, std::forward<decltype(body)>(body), ImVec2(0, 0));
         }
 
-        bool operator()(FormatArgs label, auto& index, std::ranges::random_access_range auto&& elements, ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None) const
+        bool operator()(FormatArgs label, auto& index, Detail::SizedRandomAccessRange auto&& elements, ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None) const
             requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<decltype(elements)>>>
+        {
+            return operator()(label, index, elements, std::identity{}, selFlags);
+        }
+
+        // Same as above, showing projection(element) for each element, e.g. a member pointer or a function returning an enum's name.
+        template<Detail::SizedRandomAccessRange R>
+        bool operator()(FormatArgs label, auto& index, R&& elements, Detail::LabelProjection<R> auto&& projection, ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<R>>>
         {
             bool selected = false;
-            std::decay_t<decltype(index)> i = 0;
             operator()(label, [&] {
-                for (const auto& opt : elements)
-                {
-                    if (ImGui::Selectable(Detail::TryGetValue(opt), i == index, selFlags))
-                    {
-                        index = i;
-                        selected = true;
-                    }
-                    ++i;
-                }
-                });
+                selected = Detail::ClippedSelectables(index, elements, projection, selFlags);
+            });
+
+            return selected;
+        }
+
+        struct FilterParams
+        {
+            ImVec2 size{ 0, 0 };
+            ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None;
+            size_t version = 0; // Change when the elements change without their count changing, to rebuild the search index
+            const char* hint = "Filter";
+        };
+
+        // List box preceded by a filter field narrowing the elements to those containing the typed text, through an index kept with the widget.
+        bool Filtered(FormatArgs label, auto& index, Detail::SizedRandomAccessRange auto&& elements, const FilterParams& params = {}) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<decltype(elements)>>>
+        {
+            return Filtered(label, index, elements, std::identity{}, params);
+        }
+
+        template<Detail::SizedRandomAccessRange R>
+        bool Filtered(FormatArgs label, auto& index, R&& elements, Detail::LabelProjection<R> auto&& projection, const FilterParams& params = {}) const
+            requires std::convertible_to<decltype(index), std::iter_difference_t<std::ranges::iterator_t<R>>>
+        {
+            const ImGuiID id = ImGui::GetID(label.GetValue());
+            auto& list = Detail::GetWidgetState<Detail::FilteredList>(id);
+
+            ImGui::PushOverrideID(id);
+            ImGui::SetNextItemWidth(ImGui::CalcItemSize(params.size, ImGui::CalcItemWidth(), 0.f).x);
+            ImGui::InputTextWithHint("##filter", params.hint, &list.filter);
+            ImGui::PopID();
+
+            list.Update(elements, projection, params.version);
+
+            bool selected = false;
+            operator()(label, params.size, [&] {
+                selected = Detail::FilteredSelectables(index, elements, projection, params.selFlags, list.results);
+            });
 
             return selected;
         }
 
+        struct MultiParams
+        {
+            ImVec2 size{ 0, 0 };
+            ImGuiMultiSelectFlags_ flags = MultiSelectT::DefaultFlags;
+            ImGuiSelectableFlags_ selFlags = ImGuiSelectableFlags_None;
+        };
+
+        // List box in which any number of elements can be selected, only submitting the visible rows. Returns true if the selection changed.
+        bool Multi(FormatArgs label, IndexSet& selection, Detail::SizedRandomAccessRange auto&& elements, const MultiParams& params = {}) const
+        {
+            return Multi(label, selection, elements, std::identity{}, params);
+        }
+
+        template<Detail::SizedRandomAccessRange R>
+        bool Multi(FormatArgs label, IndexSet& selection, R&& elements, Detail::LabelProjection<R> auto&& projection, const MultiParams& params = {}) const
+        {
+            const size_t count = std::ranges::size(elements);
+            bool changed = false;
+            operator()(label, params.size, [&] {
+                changed = MultiSelect(selection, count, [&](int rangeSource) {
+                    ImGuiListClipper clipper;
+                    clipper.Begin(static_cast<int>(count));
+                    if (rangeSource != -1)
+                        clipper.IncludeItemByIndex(rangeSource);
+
+                    while (clipper.Step())
+                    {
+                        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+                        {
+                            decltype(auto) value = std::invoke(projection, elements[i]);
+                            const std::string_view text = Detail::GetLabelView(value);
+                            ImGui::SetNextItemSelectionUserData(i);
+                            ImGuiExt::Selectable(i, text.data(), text.data() + text.size(), selection.Contains(static_cast<size_t>(i)), params.selFlags);
+                        }
+                    }
+                }, params.flags);
+            });
+
+            return changed;
+        }
     } ListBox;
 
+    /**
+     * Column of a data-bound NGui::Table. get(row) returns the cell's value, which is shown as text and used for sorting when it is ordered,
+     * or returns nothing and draws the cell's contents itself.
+    */
+    template<typename Get>
+    struct TableColumn
+    {
+        const char* name;
+        Get get;
+        ImGuiTableColumnFlags_ flags = ImGuiTableColumnFlags_None;
+        float width = 0.f;
+
+        constexpr TableColumn(const char* name, Get get, ImGuiTableColumnFlags_ flags = ImGuiTableColumnFlags_None, float width = 0.f)
+            : name(name), get(std::move(get)), flags(flags), width(width) {}
+    };
+
+    namespace Detail
+    {
+        // Rows from which the sort permutation is computed with a parallel sort, see SortTableOrder()
+        constexpr size_t ParallelSortThreshold = 100'000;
+
+        // Parallel stable sort of a table's row order. Out of line so includers do not pull in <execution>: it is used with MSVC's standard library,
+        // and elsewhere only when nearimgui.cpp is built with NGUI_PARALLEL_SORT, since libstdc++ implements it over TBB. Sequential otherwise.
+        void SortTableOrder(std::vector<ImU32>& order, bool (*less)(const void* context, ImU32 a, ImU32 b), const void* context);
+
+        struct TableSortState
+        {
+            std::vector<ImU32> order; // Data index of each displayed row, empty while the table is unsorted
+            size_t size = 0;
+            size_t version = 0;
+            bool valid = false;
+        };
+
+        template<typename Get, typename Row>
+        void RenderTableCell(const Get& get, const Row& row)
+        {
+            using Value = std::remove_cvref_t<std::invoke_result_t<const Get&, const Row&>>;
+            if constexpr (std::is_void_v<Value>)
+                std::invoke(get, row);
+            else
+            {
+                decltype(auto) value = std::invoke(get, row);
+
+                std::string_view text;
+                if constexpr (std::convertible_to<const Value&, std::string_view>)
+                    text = value;
+                else
+                    text = FormatToFrame("{}", value);
+
+                ImGui::TextUnformatted(text.data(), text.data() + text.size());
+            }
+        }
+
+        // Three-way comparison of the cells of two rows, 0 for columns which cannot be ordered
+        template<typename Get, typename Row>
+        int CompareTableCells(const Get& get, const Row& a, const Row& b)
+        {
+            using Value = std::remove_cvref_t<std::invoke_result_t<const Get&, const Row&>>;
+            if constexpr (std::convertible_to<const Value&, std::string_view>)
+            {
+                const int result = std::string_view(std::invoke(get, a)).compare(std::invoke(get, b));
+                return (result > 0) - (result < 0);
+            }
+            else if constexpr (std::totally_ordered<Value>)
+            {
+                decltype(auto) va = std::invoke(get, a);
+                decltype(auto) vb = std::invoke(get, b);
+                return va < vb ? -1 : (vb < va ? 1 : 0);
+            }
+            else
+                return 0;
+        }
+    }
+
+    static constexpr class TableT : protected Detail::InvokeBase
+    {
+    public:
+        struct Params
+        {
+            ImGuiTableFlags_ flags = ImGuiTableFlags_None;
+            ImVec2 outerSize{ 0.f, 0.f };
+            float innerWidth = 0.f;
+        };
+
+        void operator()(FormatArgs id, int columns, Params&& params, auto&& body) const
+        {
+            InvokeBlock<ImGui::BeginTable, ImGui::EndTable, false>(id, std::forward<decltype(body)>(body), columns, params.flags, params.outerSize, params.innerWidth);
+        }
+
+        void operator()(FormatArgs id, int columns, auto&& body) const
+        {
+            operator()(id, columns, {}, std::forward<decltype(body)>(body));
+        }
+
+        struct DataParams
+        {
+            ImGuiTableFlags_ flags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Sortable;
+            ImVec2 outerSize{ 0.f, 0.f };
+            float innerWidth = 0.f;
+            bool freezeHeader = true;
+            size_t version = 0; // Change when the data changes without its size changing, to sort it again
+        };
+
+        /**
+         * Table with one row per element of data and the given columns, of which only the visible rows are submitted.
+         * The sort permutation is kept with the table and only recomputed when the sort specs change or the data's size or version changes.
+         *
+         * NGui::Table("Signals", signals, {}, NGui::TableColumn("Name", &Signal::name), NGui::TableColumn("Value", &Signal::value));
+        */
+        template<Detail::SizedRandomAccessRange R, typename... Getters>
+        void operator()(FormatArgs id, R&& data, const DataParams& params, const TableColumn<Getters>& ...columns) const
+        {
+            const ImGuiID tableId = ImGui::GetID(id.GetValue());
+            if (!ImGui::BeginTable(id.GetValue(), static_cast<int>(sizeof...(Getters)), params.flags, params.outerSize, params.innerWidth))
+                return;
+
+            if (params.freezeHeader)
+                ImGui::TableSetupScrollFreeze(0, 1);
+            (ImGui::TableSetupColumn(columns.name, columns.flags, columns.width), ...);
+            ImGui::TableHeadersRow();
+
+            const size_t count = std::ranges::size(data);
+            auto& state = Detail::GetWidgetState<Detail::TableSortState>(tableId);
+            ImGuiTableSortSpecs* specs = ImGui::TableGetSortSpecs();
+            if (!state.valid || (specs && specs->SpecsDirty) || count != state.size || params.version != state.version)
+            {
+                Sort(state.order, data, specs, columns...);
+                state.valid = true;
+                state.size = count;
+                state.version = params.version;
+                if (specs)
+                    specs->SpecsDirty = false;
+            }
+
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(count));
+            while (clipper.Step())
+            {
+                for (int r = clipper.DisplayStart; r < clipper.DisplayEnd; ++r)
+                {
+                    const size_t i = state.order.empty() ? static_cast<size_t>(r) : state.order[r];
+                    const auto& row = data[i];
+
+                    ImGui::TableNextRow();
+                    ImGui::PushID(static_cast<int>(i));
+                    ((ImGui::TableNextColumn() ? Detail::RenderTableCell(columns.get, row) : void()), ...);
+                    ImGui::PopID();
+                }
+            }
+
+            ImGui::EndTable();
+        }
+
+    private:
+        template<typename R, typename... Getters>
+        static void Sort(std::vector<ImU32>& order, const R& data, const ImGuiTableSortSpecs* specs, const TableColumn<Getters>& ...columns)
+        {
+            if (!specs || specs->SpecsCount == 0)
+            {
+                order.clear();
+                return;
+            }
+
+            order.resize(std::ranges::size(data));
+            std::iota(order.begin(), order.end(), ImU32(0));
+
+            const auto less = [&](ImU32 ia, ImU32 ib) {
+                const auto& a = data[ia];
+                const auto& b = data[ib];
+                for (int s = 0; s < specs->SpecsCount; ++s)
+                {
+                    const ImGuiTableColumnSortSpecs& spec = specs->Specs[s];
+
+                    int result = 0;
+                    int column = 0;
+                    ((column++ == spec.ColumnIndex ? void(result = Detail::CompareTableCells(columns.get, a, b)) : void()), ...);
+
+                    if (result != 0)
+                        return spec.SortDirection == ImGuiSortDirection_Descending ? result > 0 : result < 0;
+                }
+                return false;
+            };
+
+            if (order.size() >= Detail::ParallelSortThreshold)
+            {
+                using Less = decltype(less);
+                Detail::SortTableOrder(order, [](const void* context, ImU32 a, ImU32 b) { return (*static_cast<const Less*>(context))(a, b); }, &less);
+                return;
+            }
+            std::stable_sort(order.begin(), order.end(), less);
+        }
+    } Table;
+
+    /**
+     * Set of ImGuiIDs for open and selection state of large trees and lists, in place of ImGuiStorage whose sorted vector makes every insertion O(n).
+     * Open addressing with linear probing over a power-of-two table kept at most half full, deletions shift later entries back instead of leaving tombstones.
+     * 0 is not a valid ID and cannot be stored.
+    */
+    class IdSet
+    {
+    public:
+        [[nodiscard]] bool Contains(ImGuiID id) const;
+        bool Insert(ImGuiID id); // Returns false if id was already present
+        bool Erase(ImGuiID id);  // Returns false if id was not present
+        bool Toggle(ImGuiID id); // Returns whether id is now present
+
+        void Clear();
+        void Reserve(size_t count);
+
+        [[nodiscard]] size_t Size() const { return size_; }
+        [[nodiscard]] bool Empty() const { return size_ == 0; }
+
+        template<std::invocable<ImGuiID> F>
+        void ForEach(F&& f) const
+        {
+            for (ImGuiID id : slots_)
+                if (id != 0)
+                    f(id);
+        }
+
+        // Compact form: the count then the sorted IDs as deltas, all as LEB128 varints. Typically 1 to 5 bytes per ID.
+        [[nodiscard]] std::vector<ImU8> Serialize() const;
+        // Replaces the contents with serialized data, returns false (leaving the set empty) if the data is malformed.
+        bool Deserialize(std::span<const ImU8> data);
+
+    private:
+        // Fibonacci hashing, the table always has at least 8 slots when this is called
+        [[nodiscard]] size_t Home(ImGuiID id) const { return static_cast<ImU32>(id * 0x9E3779B1u) >> shift_; }
+        [[nodiscard]] size_t Find(ImGuiID id) const;
+        void Rehash(size_t capacity);
+
+        std::vector<ImGuiID> slots_; // 0 marks an empty slot
+        size_t size_ = 0;
+        int shift_ = 0;
+    };
+
+    namespace Detail
+    {
+        // Visible rows of a TreeView, in display order: a node's open descendants directly follow it
+        template<typename Node>
+        struct TreeViewState
+        {
+            struct Row
+            {
+                Node node;
+                ImGuiID id;
+                int depth;
+                bool leaf;
+                bool open;
+            };
+
+            std::vector<Row> rows;
+            IdSet open;
+            size_t version = 0;
+            bool valid = false;
+        };
+    }
+
+    static constexpr class TreeViewT
+    {
+    public:
+        struct Params
+        {
+            ImVec2 size{ 0.f, 0.f };
+            ImGuiChildFlags_ childFlags = ImGuiChildFlags_None;
+            size_t version = 0;          // Change when the tree's structure or the open set changes, to rebuild the visible rows
+            IdSet* open = nullptr;       // Open nodes, e.g. to serialize them, otherwise kept with the tree
+            IdSet* selection = nullptr;  // Selected nodes, updated on click (Ctrl toggles) and highlighted, none if null
+        };
+
+        // ID of a node's row, as stored in the open and selection sets
+        template<typename Node> requires std::is_trivially_copyable_v<Node>
+        [[nodiscard]] ImGuiID GetNodeID(FormatArgs id, const Node& node) const
+        {
+            return ImHashData(&node, sizeof(Node), ImGui::GetID(id.GetValue()));
+        }
+
+        /**
+         * Data-driven tree kept as a flat list of its visible rows, drawn through a list clipper so only on-screen rows are submitted.
+         * Expanding or collapsing a node only inserts or removes that node's visible descendants.
+         * @param roots Random-access range of top-level nodes. Nodes are small trivially copyable handles (indices, pointers, IDs) and identify their row.
+         * @param children children(node) returns a random-access range of the node's children.
+         * @param label label(node) returns a label-like value for the node.
+         * @return The node clicked this frame, if any.
+        */
+        template<std::ranges::random_access_range R, typename Node = std::ranges::range_value_t<R>>
+        std::optional<Node> operator()(FormatArgs id, R&& roots, auto&& children, auto&& label, const Params& params = {}) const
+            requires std::is_trivially_copyable_v<Node> && Detail::SizedRandomAccessRange<std::invoke_result_t<decltype(children)&, const Node&>>
+        {
+            using State = Detail::TreeViewState<Node>;
+
+            const ImGuiID treeId = ImGui::GetID(id.GetValue());
+            auto& state = Detail::GetWidgetState<State>(treeId);
+            IdSet& openSet = params.open ? *params.open : state.open;
+
+            const auto makeRow = [&](const Node& node, int depth) {
+                const ImGuiID rowId = ImHashData(&node, sizeof(Node), treeId);
+                return typename State::Row{ node, rowId, depth, std::ranges::empty(std::invoke(children, node)), openSet.Contains(rowId) };
+            };
+
+            // Appends the rows of node and of its open descendants, depth-first without recursion
+            const auto appendSubtree = [&](std::vector<typename State::Row>& out, const typename State::Row& row) {
+                std::vector<typename State::Row> pending{ row };
+                while (!pending.empty())
+                {
+                    const auto current = pending.back();
+                    pending.pop_back();
+                    out.push_back(current);
+
+                    if (current.open && !current.leaf)
+                    {
+                        auto&& nodes = std::invoke(children, current.node);
+                        for (auto i = std::ranges::ssize(nodes); i-- > 0;)
+                            pending.push_back(makeRow(nodes[i], current.depth + 1));
+                    }
+                }
+            };
+
+            if (!state.valid || state.version != params.version)
+            {
+                state.rows.clear();
+                for (const auto& root : roots)
+                    appendSubtree(state.rows, makeRow(root, 0));
+                state.valid = true;
+                state.version = params.version;
+            }
+
+            std::optional<Node> clicked;
+            if (ImGui::BeginChild(id.GetValue(), params.size, params.childFlags))
+            {
+                const float indentSpacing = ImGui::GetStyle().IndentSpacing;
+                int toggledRow = -1;
+
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<int>(state.rows.size()));
+                while (clipper.Step())
+                {
+                    for (int r = clipper.DisplayStart; r < clipper.DisplayEnd; ++r)
+                    {
+                        auto& row = state.rows[r];
+                        decltype(auto) value = std::invoke(label, row.node);
+                        const std::string_view text = Detail::GetLabelView(value);
+
+                        bool open = row.open;
+                        const bool selected = params.selection && params.selection->Contains(row.id);
+                        if (ImGuiExt::TreeNodeRow(row.id, text.data(), text.data() + text.size(), row.depth * indentSpacing, row.leaf, selected, &open))
+                        {
+                            clicked = row.node;
+                            if (params.selection)
+                            {
+                                if (!ImGui::GetIO().KeyCtrl)
+                                    params.selection->Clear();
+                                params.selection->Toggle(row.id);
+                            }
+                        }
+                        if (open != row.open)
+                            toggledRow = r;
+                    }
+                }
+
+                if (toggledRow >= 0)
+                    Toggle(state.rows, openSet, static_cast<size_t>(toggledRow), appendSubtree);
+            }
+            ImGui::EndChild();
+
+            return clicked;
+        }
+
+    private:
+        template<typename Row>
+        static void Toggle(std::vector<Row>& rows, IdSet& openSet, size_t index, auto&& appendSubtree)
+        {
+            auto& row = rows[index];
+            row.open = !row.open;
+
+            if (row.open)
+            {
+                openSet.Insert(row.id);
+
+                std::vector<Row> subtree;
+                appendSubtree(subtree, row);
+                rows.insert(rows.begin() + index + 1, subtree.begin() + 1, subtree.end());
+            }
+            else
+            {
+                openSet.Erase(row.id);
+
+                size_t end = index + 1;
+                while (end < rows.size() && rows[end].depth > row.depth)
+                    ++end;
+                rows.erase(rows.begin() + index + 1, rows.begin() + end);
+            }
+        }
+    } TreeView;
+
+    namespace Detail
+    {
+        /**
+         * Fenwick tree over row heights: point updates, prefix sums and finding the row at an offset all take O(log n).
+         * Sums are kept in double so offsets stay exact over millions of rows.
+        */
+        class PrefixSums
+        {
+        public:
+            void Assign(std::span<const float> values); // O(n)
+            void Append(float value);
+            void Add(size_t index, float delta);
+
+            [[nodiscard]] double Prefix(size_t count) const; // Sum of the first count values
+            [[nodiscard]] double Total() const { return Prefix(tree_.size()); }
+            [[nodiscard]] size_t Find(double offset) const;  // Index of the value spanning offset, Size() if past the end
+            [[nodiscard]] size_t Size() const { return tree_.size(); }
+
+        private:
+            std::vector<double> tree_; // tree_[i - 1] holds the sum of the lowbit(i) values ending at i
+        };
+
+        struct VirtualListState
+        {
+            std::vector<float> heights;
+            PrefixSums offsets;
+            size_t version = 0;
+            bool valid = false;
+        };
+    }
+
+    static constexpr class VirtualListT
+    {
+    public:
+        struct Params
+        {
+            ImVec2 size{ 0.f, 0.f };
+            ImGuiChildFlags_ childFlags = ImGuiChildFlags_None;
+            float estimatedHeight = 0.f; // Height assumed for rows not drawn yet, one line with spacing if 0
+            size_t version = 0;          // Change when existing rows change, to measure them again; appended rows are picked up on their own
+        };
+
+        /**
+         * List of rows with varying heights, of which only those in view are drawn by body(element) or body(element, index).
+         * Each drawn row's height is measured from the cursor movement and kept in a Fenwick tree, so finding the first visible row from the scroll offset is O(log n).
+         * Rows which were never drawn count with the estimated height.
+        */
+        template<Detail::SizedRandomAccessRange R>
+        void operator()(FormatArgs id, R&& elements, auto&& body, const Params& params = {}) const
+        {
+            auto& state = Detail::GetWidgetState<Detail::VirtualListState>(ImGui::GetID(id.GetValue()));
+
+            if (ImGui::BeginChild(id.GetValue(), params.size, params.childFlags))
+            {
+                const float estimate = params.estimatedHeight > 0.f ? params.estimatedHeight : ImGui::GetTextLineHeightWithSpacing();
+                const size_t count = std::ranges::size(elements);
+                if (!state.valid || state.version != params.version || count < state.heights.size())
+                {
+                    state.heights.assign(count, estimate);
+                    state.offsets.Assign(state.heights);
+                    state.valid = true;
+                    state.version = params.version;
+                }
+                while (state.heights.size() < count)
+                {
+                    state.heights.push_back(estimate);
+                    state.offsets.Append(estimate);
+                }
+
+                const float startY = ImGui::GetCursorPosY();
+                const double top = ImGui::GetScrollY() - startY;
+                const double bottom = top + ImGui::GetWindowHeight();
+
+                size_t i = state.offsets.Find(std::max(top, 0.0));
+                ImGui::SetCursorPosY(startY + static_cast<float>(state.offsets.Prefix(i)));
+                for (double y = state.offsets.Prefix(i); i < count && y < bottom; ++i)
+                {
+                    const float rowY = ImGui::GetCursorPosY();
+
+                    ImGui::PushID(static_cast<int>(i));
+                    if constexpr (std::invocable<decltype(body)&, decltype(elements[i]), size_t>)
+                        body(elements[i], i);
+                    else
+                        body(elements[i]);
+                    ImGui::PopID();
+
+                    const float height = ImGui::GetCursorPosY() - rowY;
+                    if (height != state.heights[i])
+                    {
+                        state.offsets.Add(i, height - state.heights[i]);
+                        state.heights[i] = height;
+                    }
+                    y += height;
+                }
+
+                // Reserve the full height so the scrollbar covers every row
+                ImGui::SetCursorPosY(startY + static_cast<float>(state.offsets.Total()));
+                ImGui::Dummy(ImVec2(0.f, 0.f));
+            }
+            ImGui::EndChild();
+        }
+    } VirtualList;
+
+    /**
+     * Read-only text shown by NGui::TextView, either a memory-mapped file or caller-owned bytes.
+     * Line starts are indexed on a background thread so even multi-gigabyte files can be shown as soon as they are opened, and lines appear as they are indexed.
+    */
+    static constexpr struct TextInMemoryT {} TextInMemory;
+
+    class TextDocument
+    {
+    public:
+        // Maps the file, which must not change while it is open. With follow, the file is read into memory instead and bytes later appended to it
+        // are read and indexed as they arrive, tail -F style: a truncated file, or a new one rotated in at the path, is read again from its start.
+        explicit TextDocument(const std::filesystem::path& path, bool follow = false);
+        // Uses caller-owned text, which must stay valid until the document is destroyed or extended.
+        // Tagged since strings convert to both a path and a span.
+        TextDocument(TextInMemoryT, std::span<const char> text);
+        ~TextDocument();
+
+        TextDocument(const TextDocument&) = delete;
+        TextDocument& operator=(const TextDocument&) = delete;
+
+        // Replaces caller-owned text with a longer span starting with the same bytes, only the new bytes are indexed.
+        void Extend(std::span<const char> text);
+
+        [[nodiscard]] bool IsOpen() const;          // False if the file could not be opened or mapped
+        [[nodiscard]] size_t GetSize() const;       // Bytes mapped, read or provided so far
+        [[nodiscard]] size_t GetIndexedSize() const;
+        [[nodiscard]] size_t GetLineCount() const;  // Lines indexed so far
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+
+        friend class TextViewT;
+    };
+
+    static constexpr class TextViewT
+    {
+    public:
+        struct Params
+        {
+            ImVec2 size{ 0.f, 0.f };
+            ImGuiChildFlags_ childFlags = ImGuiChildFlags_None;
+            ImGuiWindowFlags_ flags = ImGuiWindowFlags_HorizontalScrollbar;
+            bool follow = false;          // Keep the view on the last line as lines are added, unless scrolled up
+            size_t maxLineLength = 4096;  // Longer lines are cut when displayed
+        };
+
+        // Shows the document's lines in a child window, only drawing those in view.
+        void operator()(FormatArgs id, TextDocument& document, const Params& params = {}) const;
+    } TextView;
+
+    enum class LogSeverity : ImU8
+    {
+        Trace,
+        Debug,
+        Info,
+        Warning,
+        Error,
+    };
+
+    /**
+     * Log records shown by NGui::LogConsole.
+     * Push() can be called from any thread: records are copied into a ring of pre-sized slots without locking or allocating, and moved to the
+     * buffer's line store at the start of each frame by NGui::NewFrame(). Producers never wait for the UI thread; if the ring fills up between two
+     * frames the new records are dropped and counted instead.
+    */
+    class LogBuffer
+    {
+    public:
+        // Longer records are cut, so every record fits in one slot
+        static constexpr size_t MaxRecordLength = 236;
+
+        struct Params
+        {
+            size_t capacity = 1 << 16;   // Records buffered between two frames, rounded up to a power of two
+            size_t maxLines = 1'000'000; // Oldest lines are dropped past this, a chunk of lines at a time
+        };
+
+        explicit LogBuffer(const Params& params = {});
+        ~LogBuffer();
+
+        LogBuffer(const LogBuffer&) = delete;
+        LogBuffer& operator=(const LogBuffer&) = delete;
+
+        // Thread-safe and lock-free, returns false if the record was dropped because the ring was full.
+        bool Push(LogSeverity severity, std::string_view text);
+
+        template<typename... Args>
+        bool Push(LogSeverity severity, std::format_string<Args...> fmt, Args&& ...args)
+        {
+            std::array<char, MaxRecordLength> text;
+            const auto result = std::format_to_n(text.data(), text.size(), fmt, std::forward<Args>(args)...);
+            return Push(severity, std::string_view(text.data(), std::min<size_t>(result.size, text.size())));
+        }
+
+        // Removes all stored lines, must be called from the UI thread.
+        void Clear();
+
+        [[nodiscard]] size_t GetLineCount() const;
+        [[nodiscard]] size_t GetDroppedCount() const;
+
+    private:
+        struct Impl;
+        std::shared_ptr<Impl> impl_;
+
+        friend class LogConsoleT;
+    };
+
+    static constexpr class LogConsoleT
+    {
+    public:
+        struct Params
+        {
+            ImVec2 size{ 0.f, 0.f };
+            ImGuiChildFlags_ childFlags = ImGuiChildFlags_None;
+            bool toolbar = true;    // Severity and text filters above the lines
+            bool timestamps = true; // Seconds since the buffer was created
+            bool follow = true;     // Keep the view on the last line as lines are added, unless scrolled up
+        };
+
+        // Shows the buffer's lines that pass the filters, only drawing those in view.
+        void operator()(FormatArgs id, LogBuffer& buffer, const Params& params = {}) const;
+    } LogConsole;
+
+    static constexpr class PlotT
+    {
+    public:
+        struct Params
+        {
+            ImVec2 size{ 0.f, 0.f };                  // Zero width uses the item width, zero height fits the label like ImGui::PlotLines
+            std::optional<float> min = std::nullopt;  // Vertical range, fitted to the samples in view when unset
+            std::optional<float> max = std::nullopt;
+            size_t version = 0;                       // Change when existing samples were modified, appended samples are picked up without it
+        };
+
+        /**
+         * Line plot which reduces the samples in view to one min/max range per pixel column instead of walking every sample.
+         * A min/max pyramid is kept per widget and extended as samples are appended, so panning (drag) and zooming (mouse wheel, double-click to
+         * reset) stay cheap over tens of millions of samples. While zoomed onto the newest samples, the view follows appended ones.
+        */
+        void operator()(FormatArgs label, std::span<const float> samples, const Params& params = {}) const;
+        void operator()(FormatArgs label, std::span<const double> samples, const Params& params = {}) const;
+    } Plot;
+
+    namespace Detail
+    {
+        // Shards per metric, one per hardware thread. Threads beyond this share shards but still never take a lock.
+        size_t GetMetricShardCount();
+
+        template<typename T>
+        struct alignas(64) PaddedAtomic
+        {
+            std::atomic<T> value{};
+        };
+
+        // Shard used by the calling thread, assigned round-robin on first use
+        inline size_t GetMetricShard()
+        {
+            static std::atomic<size_t> next = 0;
+            thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % GetMetricShardCount();
+            return shard;
+        }
+    }
+
+    /**
+     * Counters, gauges and histograms which services update from any thread, shown with NGui::MetricsView or read back for NGui::Text,
+     * NGui::ProgressBar and NGui::Plot.
+     * Updates are relaxed atomic operations on the calling thread's shard, each on its own cache line, so hot paths never lock nor contend on a
+     * shared line. NGui::NewFrame() folds the shards of every metric once per frame into the values read by the UI.
+    */
+    class Metrics
+    {
+        struct Impl;
+
+    public:
+        // Folded values kept per metric, one per frame
+        static constexpr size_t HistoryLength = 256;
+
+        class Metric
+        {
+        public:
+            virtual ~Metric() = default;
+
+            [[nodiscard]] const std::string& GetName() const { return name_; }
+            // Per-frame values, oldest first, contiguous so they can be passed to ImGui::PlotLines. The window slides every frame, NGui::Plot would need a new version each time.
+            [[nodiscard]] std::span<const float> GetHistory() const { return { history_.data() + historyHead_, HistoryLength }; }
+
+        protected:
+            explicit Metric(std::string_view name) : name_(name), history_(2 * HistoryLength) {}
+
+            void PushHistory(float value)
+            {
+                // Written twice so the last HistoryLength values are always contiguous
+                history_[historyHead_] = history_[historyHead_ + HistoryLength] = value;
+                historyHead_ = (historyHead_ + 1) % HistoryLength;
+            }
+
+        private:
+            virtual void Fold(float deltaTime) = 0;
+
+            std::string name_;
+            std::vector<float> history_;
+            size_t historyHead_ = 0;
+
+            friend struct Impl;
+        };
+
+        class Counter : public Metric
+        {
+        public:
+            explicit Counter(std::string_view name) : Metric(name), shards_(Detail::GetMetricShardCount()) {}
+
+            void Add(ImS64 delta = 1) { shards_[Detail::GetMetricShard()].value.fetch_add(delta, std::memory_order_relaxed); }
+
+            [[nodiscard]] ImS64 GetTotal() const { return total_; }
+            // Per second over the last frame, also what the history holds
+            [[nodiscard]] float GetRate() const { return rate_; }
+
+        private:
+            void Fold(float deltaTime) override;
+
+            std::vector<Detail::PaddedAtomic<ImS64>> shards_;
+            ImS64 total_ = 0;
+            float rate_ = 0.f;
+        };
+
+        // Last value set, by any thread. Sets are plain stores which need no sharding.
+        class Gauge : public Metric
+        {
+        public:
+            Gauge(std::string_view name, float min, float max) : Metric(name), min_(min), max_(max) {}
+
+            void Set(double value) { value_.value.store(value, std::memory_order_relaxed); }
+
+            [[nodiscard]] double GetValue() const { return folded_; }
+            [[nodiscard]] bool HasRange() const { return max_ > min_; }
+            // Position of the value in the range given when the gauge was added, for NGui::ProgressBar
+            [[nodiscard]] float GetFraction() const { return HasRange() ? ImSaturate((static_cast<float>(folded_) - min_) / (max_ - min_)) : 0.f; }
+
+        private:
+            void Fold(float deltaTime) override;
+
+            Detail::PaddedAtomic<double> value_;
+            double folded_ = 0.0;
+            float min_, max_;
+        };
+
+        // Counts of values in equal buckets over [min, max), plus one bucket each for values below and above
+        class Histogram : public Metric
+        {
+        public:
+            Histogram(std::string_view name, float min, float max, size_t buckets);
+
+            void Record(float value)
+            {
+                const float position = (value - min_) * scale_;
+                const size_t bucket = !(position >= 0.f) ? 0 : position >= static_cast<float>(bucketCount_) ? bucketCount_ + 1 : static_cast<size_t>(position) + 1;
+                lines_[Detail::GetMetricShard() * shardStride_ + bucket / CountsPerLine].counts[bucket % CountsPerLine].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            [[nodiscard]] ImU64 GetCount() const { return count_; }
+            // Folded counts, underflow first and overflow last
+            [[nodiscard]] std::span<const ImU64> GetBuckets() const { return counts_; }
+            // Estimated by interpolating within the bucket holding the quantile
+            [[nodiscard]] float GetQuantile(float q) const;
+            // Values recorded per second over the last frame, also what the history holds
+            [[nodiscard]] float GetRate() const { return rate_; }
+
+        private:
+            static constexpr size_t CountsPerLine = 64 / sizeof(ImU64);
+
+            struct alignas(64) CountLine
+            {
+                std::atomic<ImU64> counts[CountsPerLine]{};
+            };
+
+            void Fold(float deltaTime) override;
+
+            float min_, max_, scale_;
+            size_t bucketCount_;
+            size_t shardStride_;
+            std::vector<CountLine> lines_;
+            std::vector<ImU64> counts_;
+            ImU64 count_ = 0;
+            float rate_ = 0.f;
+        };
+
+        Metrics();
+        ~Metrics();
+
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+        // Adding metrics takes a lock, keep the returned references rather than adding on hot paths. They stay valid as long as the Metrics.
+        Counter& AddCounter(std::string_view name);
+        // The range is optional, and only used to show the gauge as a progress bar
+        Gauge& AddGauge(std::string_view name, float min = 0.f, float max = 0.f);
+        Histogram& AddHistogram(std::string_view name, float min, float max, size_t buckets = 32);
+
+    private:
+        std::shared_ptr<Impl> impl_;
+
+        friend class MetricsViewT;
+    };
+
+    static constexpr class MetricsViewT
+    {
+    public:
+        struct Params
+        {
+            ImGuiTableFlags_ flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable;
+            ImVec2 outerSize{ 0.f, 0.f };
+            float historyHeight = 0.f; // Height of the history plots, zero to hide them
+        };
+
+        // Table with a row per metric: counters with their rate, gauges as progress bars when they have a range, histograms with their quantiles.
+        void operator()(FormatArgs id, Metrics& metrics, const Params& params = {}) const;
+    } MetricsView;
+
     struct Menu
     {
         void SubMenu(FormatArgs name, bool enabled, auto&& body) const
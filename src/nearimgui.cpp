@@ -3,9 +3,49 @@
 #endif
 
 #include "nearimgui.h"
+#include "nearimgui_internal.h"
 
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <shared_mutex>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NGUI_SSE2
+#include <emmintrin.h>
+#endif
+
+// MSVC's parallel algorithms need nothing else, libstdc++ implements them over TBB so elsewhere they are opt-in
+#if defined(_MSC_VER) && !defined(NGUI_PARALLEL_SORT)
+#define NGUI_PARALLEL_SORT
+#endif
+#ifdef NGUI_PARALLEL_SORT
+#include <execution>
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace NGui::ImGuiExt
 {
@@ -246,7 +286,7 @@ namespace NGui::ImGuiExt
         const ImGuiID id = window->GetID(label);
         const float w = CalcItemWidth();
 
-        const ImVec2 label_size = CalcTextSize(label, NULL, true);
+        const ImVec2 label_size = Detail::CalcLabelSize(label);
         const ImRect frame_bb(window->DC.CursorPos, window->DC.CursorPos + ImVec2(w, label_size.y + style.FramePadding.y * 2.0f));
         const ImRect total_bb(frame_bb.Min, frame_bb.Max + ImVec2(label_size.x > 0.0f ? style.ItemInnerSpacing.x + label_size.x : 0.0f, 0.0f));
 
@@ -321,40 +361,2340 @@ namespace NGui::ImGuiExt
         IMGUI_TEST_ENGINE_ITEM_INFO(id, label, g.LastItemData.StatusFlags | (temp_input_allowed ? ImGuiItemStatusFlags_Inputable : 0));
         return value_changed;
     }
+
+    bool ButtonEx(ImGuiID id, const char* label, const char* label_end, const ImVec2& label_size, const ImVec2& size_arg, ImGuiButtonFlags flags)
+    {
+        using namespace ImGui;
+
+        ImGuiWindow* window = GetCurrentWindow();
+        if (window->SkipItems)
+            return false;
+
+        ImGuiContext& g = *GImGui;
+        const ImGuiStyle& style = g.Style;
+
+        ImVec2 pos = window->DC.CursorPos;
+        if ((flags & ImGuiButtonFlags_AlignTextBaseLine) && style.FramePadding.y < window->DC.CurrLineTextBaseOffset) // Try to vertically align buttons that are smaller/have no padding so that text baseline matches (bit hacky, since it shouldn't be a flag)
+            pos.y += window->DC.CurrLineTextBaseOffset - style.FramePadding.y;
+        ImVec2 size = CalcItemSize(size_arg, label_size.x + style.FramePadding.x * 2.0f, label_size.y + style.FramePadding.y * 2.0f);
+
+        const ImRect bb(pos, pos + size);
+        ItemSize(size, style.FramePadding.y);
+        if (!ItemAdd(bb, id))
+            return false;
+
+        bool hovered, held;
+        bool pressed = ButtonBehavior(bb, id, &hovered, &held, flags);
+
+        // Render
+        const ImU32 col = GetColorU32((held && hovered) ? ImGuiCol_ButtonActive : hovered ? ImGuiCol_ButtonHovered : ImGuiCol_Button);
+        RenderNavHighlight(bb, id);
+        RenderFrame(bb.Min, bb.Max, col, true, style.FrameRounding);
+
+        if (g.LogEnabled)
+            LogSetNextTextDecoration("[", "]");
+        RenderTextClipped(bb.Min + style.FramePadding, bb.Max - style.FramePadding, label, label_end, &label_size, style.ButtonTextAlign, &bb);
+
+        IMGUI_TEST_ENGINE_ITEM_INFO(id, label, g.LastItemData.StatusFlags);
+        return pressed;
+    }
+
+    bool Checkbox(ImGuiID id, const char* label, const char* label_end, const ImVec2& label_size, bool* v)
+    {
+        using namespace ImGui;
+
+        ImGuiWindow* window = GetCurrentWindow();
+        if (window->SkipItems)
+            return false;
+
+        ImGuiContext& g = *GImGui;
+        const ImGuiStyle& style = g.Style;
+
+        const float square_sz = GetFrameHeight();
+        const ImVec2 pos = window->DC.CursorPos;
+        const ImRect total_bb(pos, pos + ImVec2(square_sz + (label_size.x > 0.0f ? style.ItemInnerSpacing.x + label_size.x : 0.0f), label_size.y + style.FramePadding.y * 2.0f));
+        ItemSize(total_bb, style.FramePadding.y);
+        const bool is_visible = ItemAdd(total_bb, id);
+        const bool is_multi_select = (g.LastItemData.InFlags & ImGuiItemFlags_IsMultiSelect) != 0;
+        if (!is_visible)
+            if (!is_multi_select || !g.BoxSelectState.UnclipMode || !g.BoxSelectState.UnclipRect.Overlaps(total_bb)) // Extra layer of "no logic clip" for box-select support
+            {
+                IMGUI_TEST_ENGINE_ITEM_INFO(id, label, g.LastItemData.StatusFlags | ImGuiItemStatusFlags_Checkable | (*v ? ImGuiItemStatusFlags_Checked : 0));
+                return false;
+            }
+
+        // Range-Selection/Multi-selection support (header)
+        bool checked = *v;
+        if (is_multi_select)
+            MultiSelectItemHeader(id, &checked, NULL);
+
+        bool hovered, held;
+        bool pressed = ButtonBehavior(total_bb, id, &hovered, &held);
+
+        // Range-Selection/Multi-selection support (footer)
+        if (is_multi_select)
+            MultiSelectItemFooter(id, &checked, &pressed);
+        else if (pressed)
+            checked = !checked;
+
+        if (*v != checked)
+        {
+            *v = checked;
+            pressed = true; // return value
+            MarkItemEdited(id);
+        }
+
+        const ImRect check_bb(pos, pos + ImVec2(square_sz, square_sz));
+        const bool mixed_value = (g.LastItemData.InFlags & ImGuiItemFlags_MixedValue) != 0;
+        if (is_visible)
+        {
+            RenderNavHighlight(total_bb, id);
+            RenderFrame(check_bb.Min, check_bb.Max, GetColorU32((held && hovered) ? ImGuiCol_FrameBgActive : hovered ? ImGuiCol_FrameBgHovered : ImGuiCol_FrameBg), true, style.FrameRounding);
+            ImU32 check_col = GetColorU32(ImGuiCol_CheckMark);
+            if (mixed_value)
+            {
+                // Undocumented tristate/mixed/indeterminate checkbox (#2644)
+                // This may seem awkwardly designed because the aim is to make ImGuiItemFlags_MixedValue supported by all widgets (not just checkbox)
+                ImVec2 pad(ImMax(1.0f, IM_TRUNC(square_sz / 3.6f)), ImMax(1.0f, IM_TRUNC(square_sz / 3.6f)));
+                window->DrawList->AddRectFilled(check_bb.Min + pad, check_bb.Max - pad, check_col, style.FrameRounding);
+            }
+            else if (*v)
+            {
+                const float pad = ImMax(1.0f, IM_TRUNC(square_sz / 6.0f));
+                RenderCheckMark(window->DrawList, check_bb.Min + ImVec2(pad, pad), check_col, square_sz - pad * 2.0f);
+            }
+        }
+        const ImVec2 label_pos = ImVec2(check_bb.Max.x + style.ItemInnerSpacing.x, check_bb.Min.y + style.FramePadding.y);
+        if (g.LogEnabled)
+            LogRenderedText(&label_pos, mixed_value ? "[~]" : *v ? "[x]" : "[ ]");
+        if (is_visible && label_size.x > 0.0f)
+            RenderText(label_pos, label, label_end, false);
+
+        IMGUI_TEST_ENGINE_ITEM_INFO(id, label, g.LastItemData.StatusFlags | ImGuiItemStatusFlags_Checkable | (*v ? ImGuiItemStatusFlags_Checked : 0));
+        return pressed;
+    }
+
+    bool Selectable(int id, const char* label, const char* label_end, bool selected, ImGuiSelectableFlags flags)
+    {
+        using namespace ImGui;
+
+        ImGuiContext& g = *GImGui;
+        ImGuiWindow* window = g.CurrentWindow;
+        const ImVec2 text_pos = window->DC.CursorPos + ImVec2(0.0f, window->DC.CurrLineTextBaseOffset);
+        const ImVec2 label_size = Detail::CalcLabelSize(label, label_end);
+
+        // The empty visible label gives the usual selectable height, the text is drawn over it from its own bounds.
+        // Its width is passed on so the layout, and auto-resizing windows with it, still account for the label.
+        PushID(id);
+        const bool pressed = ImGui::Selectable("##", selected, flags | ImGuiSelectableFlags_SpanAvailWidth, ImVec2(label_size.x, 0.0f));
+        PopID();
+
+        if (IsItemVisible() && label != label_end)
+        {
+            const ImRect bb = g.LastItemData.Rect;
+            const bool disabled = (flags & ImGuiSelectableFlags_Disabled) && !(g.CurrentItemFlags & ImGuiItemFlags_Disabled);
+            if (disabled)
+                BeginDisabled();
+            RenderTextClipped(text_pos, bb.Max, label, label_end, &label_size, g.Style.SelectableTextAlign, &bb);
+            if (disabled)
+                EndDisabled();
+        }
+
+        return pressed;
+    }
+
+    bool TreeNodeRow(ImGuiID id, const char* label, const char* label_end, float indent, bool leaf, bool selected, bool* open)
+    {
+        using namespace ImGui;
+
+        ImGuiWindow* window = GetCurrentWindow();
+        if (window->SkipItems)
+            return false;
+
+        ImGuiContext& g = *GImGui;
+        const ImGuiStyle& style = g.Style;
+        const ImVec2 label_size = Detail::CalcLabelSize(label, label_end);
+
+        // Same layout as an unframed TreeNode spanning the available width, shifted right by indent
+        const ImVec2 pos = window->DC.CursorPos;
+        const float frame_height = ImMax(g.FontSize, label_size.y);
+        const float text_offset_x = indent + g.FontSize + style.FramePadding.x * 2.0f;
+        const ImVec2 text_pos(pos.x + text_offset_x, pos.y);
+        const ImRect frame_bb(pos.x, pos.y, window->WorkRect.Max.x, pos.y + frame_height);
+
+        ItemSize(ImVec2(text_offset_x + label_size.x, frame_height), 0.0f);
+        if (!ItemAdd(frame_bb, id))
+            return false;
+
+        bool hovered, held;
+        const bool pressed = ButtonBehavior(frame_bb, id, &hovered, &held, ImGuiButtonFlags_PressedOnClickRelease);
+
+        bool toggled = false;
+        if (!leaf)
+        {
+            const float arrow_x1 = pos.x + indent - style.TouchExtraPadding.x;
+            const float arrow_x2 = pos.x + indent + g.FontSize + style.FramePadding.x * 2.0f + style.TouchExtraPadding.x;
+            if (pressed && g.IO.MousePos.x >= arrow_x1 && g.IO.MousePos.x < arrow_x2)
+                toggled = true;
+            if (hovered && IsMouseDoubleClicked(ImGuiMouseButton_Left))
+                toggled = true;
+            if (g.NavId == id && g.NavMoveDir == ImGuiDir_Left && *open)
+            {
+                toggled = true;
+                NavMoveRequestCancel();
+            }
+            if (g.NavId == id && g.NavMoveDir == ImGuiDir_Right && !*open)
+            {
+                toggled = true;
+                NavMoveRequestCancel();
+            }
+        }
+        if (toggled)
+            *open = !*open;
+
+        // Render
+        if (hovered || selected)
+        {
+            const ImU32 bg_col = GetColorU32((held && hovered) ? ImGuiCol_HeaderActive : hovered ? ImGuiCol_HeaderHovered : ImGuiCol_Header);
+            RenderFrame(frame_bb.Min, frame_bb.Max, bg_col, false);
+        }
+        RenderNavHighlight(frame_bb, id, ImGuiNavHighlightFlags_Compact);
+
+        const ImU32 text_col = GetColorU32(ImGuiCol_Text);
+        if (!leaf)
+            RenderArrow(window->DrawList, ImVec2(pos.x + indent + style.FramePadding.x, text_pos.y + g.FontSize * 0.15f), text_col, *open ? ImGuiDir_Down : ImGuiDir_Right, 0.70f);
+        RenderText(text_pos, label, label_end, false);
+
+        IMGUI_TEST_ENGINE_ITEM_INFO(id, label, g.LastItemData.StatusFlags | (leaf ? 0 : ImGuiItemStatusFlags_Openable) | (*open ? ImGuiItemStatusFlags_Opened : 0));
+        return pressed && !toggled;
+    }
 }
 
 namespace NGui::Detail
 {
 
+void FrameArena::AddBlock(size_t minimumSize)
+{
+    constexpr size_t MinimumBlockSize = 16 * 1024;
+    size_t blockSize = std::max({ minimumSize, MinimumBlockSize, blocks_.empty() ? 0 : blocks_.back().size * 2 });
+    blocks_.emplace_back(std::make_unique<char[]>(blockSize), blockSize);
+    used_ = 0;
+}
+
+char* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    IM_ASSERT(std::has_single_bit(alignment));
+
+    // Aligns the address rather than the offset, blocks are only aligned for char
+    const auto alignedOffset = [alignment](const char* data, size_t used) {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(data) + used;
+        return used + (((address + alignment - 1) & ~uintptr_t(alignment - 1)) - address);
+    };
+
+    if (!blocks_.empty())
+    {
+        auto& block = blocks_.back();
+        const size_t offset = alignedOffset(block.data.get(), used_);
+        if (offset + size <= block.size)
+        {
+            used_ = offset + size;
+            return block.data.get() + offset;
+        }
+    }
+
+    AddBlock(size + alignment);
+
+    char* data = blocks_.back().data.get();
+    const size_t offset = alignedOffset(data, 0);
+    used_ = offset + size;
+    return data + offset;
+}
+
+std::span<char> FrameArena::GetAvailable(size_t minimumSize)
+{
+    if (blocks_.empty() || blocks_.back().size - used_ < minimumSize)
+        AddBlock(minimumSize);
+
+    auto& block = blocks_.back();
+    return { block.data.get() + used_, block.size - used_ };
+}
+
+FrameArena::~FrameArena()
+{
+    RunDestructors();
+}
+
+void FrameArena::RunDestructors()
+{
+    for (Destructor* d = destructors_; d != nullptr; d = d->next)
+        d->destroy(d->object);
+    destructors_ = nullptr;
+}
+
+void FrameArena::Reset()
+{
+    RunDestructors();
+
+    // Merge everything used last frame into one block so the next frame fits without growing
+    if (blocks_.size() > 1)
+    {
+        size_t totalSize = 0;
+        for (const auto& block : blocks_)
+            totalSize += block.size;
+
+        blocks_.clear();
+        blocks_.emplace_back(std::make_unique<char[]>(totalSize), totalSize);
+    }
+
+    used_ = 0;
+}
+
 const char* CacheString(std::string_view sv)
 {
-    thread_local std::string buf;
-    buf.assign(sv);
-    return buf.c_str();
+    char* buf = GetFrameArena().Allocate(sv.size() + 1);
+    std::memcpy(buf, sv.data(), sv.size());
+    buf[sv.size()] = '\0';
+    return buf;
 }
 
 const char* CacheString(std::string&& s)
 {
-    thread_local std::string buf;
-    buf = s;
-    return buf.c_str();
+    return CacheString(std::string_view(s));
 }
 
-std::vector<std::unique_ptr<BaseCallback>> callbacks;
-std::mutex callbacksLock;
+// Cache entries not used for this many frames are discarded
+constexpr int CacheEntryLifetime = 120;
 
-BaseCallback* CacheCallback(std::unique_ptr<BaseCallback>&& callback)
+template<typename Map>
+void EvictStaleEntries(Map& map)
 {
-    std::lock_guard guard(callbacksLock);
-    callbacks.push_back(std::move(callback));
-    return callbacks.back().get();
+    const int frame = ImGui::GetFrameCount();
+    if (frame % CacheEntryLifetime != 0)
+        return;
+
+    std::erase_if(map, [frame](const auto& kv) { return frame - kv.second.lastFrame > CacheEntryLifetime; });
 }
 
+// 64-bit hash of text read a word at a time, a small fraction of the cost of measuring it
+ImU64 HashText(std::string_view text, ImU64 seed)
+{
+    const auto mix = [](ImU64 h, ImU64 word) {
+        h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+        return h ^ (h >> 32);
+    };
+
+    ImU64 h = mix(seed, text.size());
+    size_t i = 0;
+    for (; i + sizeof(ImU64) <= text.size(); i += sizeof(ImU64))
+    {
+        ImU64 word;
+        std::memcpy(&word, text.data() + i, sizeof(word));
+        h = mix(h, word);
+    }
+    if (i < text.size())
+    {
+        ImU64 word = 0;
+        std::memcpy(&word, text.data() + i, text.size() - i);
+        h = mix(h, word);
+    }
+    return h;
 }
-namespace NGui
+
+// Measured text is keyed by its bytes, so a hash collision can only cost a comparison. Lookups take a view, entries own a copy.
+struct TextSizeKeyView
 {
-    void NewFrame()
+    ImFont* font;
+    float fontSize;
+    std::string_view text;
+
+    bool operator==(const TextSizeKeyView&) const = default;
+};
+
+struct TextSizeKey
+{
+    ImFont* font;
+    float fontSize;
+    std::string text;
+
+    operator TextSizeKeyView() const { return { font, fontSize, text }; }
+};
+
+struct TextSizeKeyHash
+{
+    using is_transparent = void;
+
+    size_t operator()(const TextSizeKeyView& key) const
+    {
+        return static_cast<size_t>(HashText(key.text, reinterpret_cast<uintptr_t>(key.font) ^ std::bit_cast<ImU32>(key.fontSize)));
+    }
+    size_t operator()(const TextSizeKey& key) const { return (*this)(TextSizeKeyView(key)); }
+};
+
+struct TextSizeKeyEqual
+{
+    using is_transparent = void;
+
+    template<typename A, typename B>
+    bool operator()(const A& a, const B& b) const { return TextSizeKeyView(a) == TextSizeKeyView(b); }
+};
+
+// Label text has static storage, its address and length identify it
+struct LabelSizeKey
+{
+    ImFont* font;
+    float fontSize;
+    const char* text;
+    ImU32 length;
+
+    bool operator==(const LabelSizeKey&) const = default;
+};
+
+struct LabelSizeKeyHash
+{
+    size_t operator()(const LabelSizeKey& key) const
+    {
+        const ImU64 words[] = { reinterpret_cast<uintptr_t>(key.font), reinterpret_cast<uintptr_t>(key.text), (ImU64(std::bit_cast<ImU32>(key.fontSize)) << 32) | key.length };
+        return static_cast<size_t>(HashText({ reinterpret_cast<const char*>(words), sizeof(words) }, 0));
+    }
+};
+
+struct TextSizeEntry
+{
+    ImVec2 size;
+    int lastFrame = -1;
+};
+
+struct FontAtlasSignature
+{
+    ImFontAtlas* atlas = nullptr;
+    ImTextureID texture{};
+    int width = 0;
+    int height = 0;
+    int fontCount = 0;
+
+    bool operator==(const FontAtlasSignature&) const = default;
+};
+
+// Per-frame work registered by objects living outside the context, dropped once the object is destroyed
+struct FrameHook
+{
+    virtual ~FrameHook() = default;
+    virtual void OnNewFrame() = 0;
+};
+
+// Everything NGui keeps between calls, owned by the ImGui context it was created for
+struct ContextState
+{
+    FrameArena frameArena;
+    std::unordered_map<ImGuiID, MemoizedString> memoizedStrings;
+    std::unordered_map<ImGuiID, PersistentCallback> persistentCallbacks;
+    std::unordered_map<TextSizeKey, TextSizeEntry, TextSizeKeyHash, TextSizeKeyEqual> textSizes;
+    std::unordered_map<LabelSizeKey, TextSizeEntry, LabelSizeKeyHash> labelSizes;
+    FontAtlasSignature textSizesAtlas;
+    std::unordered_map<ImGuiID, WidgetState> widgetStates;
+    FrameStats currentFrameStats;
+    FrameStats lastFrameStats;
+    std::vector<std::weak_ptr<FrameHook>> frameHooks;
+};
+
+// Identifies NGui's hook among the context hooks
+constexpr ImGuiID ContextHookOwner = 0x4E477569;
+
+// Bumped whenever a context shuts down, so no thread trusts a cached pointer to a context which may since have been freed and reallocated
+std::atomic<ImU32> ContextShutdowns = 0;
+
+// Last context looked up on this thread, most threads only ever use one
+struct ContextStateCache
+{
+    ImGuiContext* context = nullptr;
+    ContextState* state = nullptr;
+    ImU32 shutdowns = 0;
+};
+
+thread_local ContextStateCache LastContextState;
+
+/**
+ * The state is attached to the context through a shutdown hook, which also frees it.
+ * Finding it again is a linear search over the context's hooks, so the result is cached per thread until any context shuts down.
+*/
+ContextState& GetContextState(ImGuiContext& ctx)
+{
+    const ImU32 shutdowns = ContextShutdowns.load(std::memory_order_acquire);
+    if (LastContextState.context == &ctx && LastContextState.shutdowns == shutdowns)
+        return *LastContextState.state;
+
+    ContextState* state = nullptr;
+    for (const auto& hook : ctx.Hooks)
+        if (hook.Owner == ContextHookOwner)
+            state = static_cast<ContextState*>(hook.UserData);
+
+    if (!state)
+    {
+        ImGuiContextHook hook;
+        hook.Type = ImGuiContextHookType_Shutdown;
+        hook.Owner = ContextHookOwner;
+        hook.Callback = [](ImGuiContext*, ImGuiContextHook* hook) {
+            ContextShutdowns.fetch_add(1, std::memory_order_release);
+            delete static_cast<ContextState*>(hook->UserData);
+        };
+        hook.UserData = state = new ContextState;
+        ImGui::AddContextHook(&ctx, &hook);
+    }
+
+    LastContextState = { &ctx, state, shutdowns };
+    return *state;
+}
+
+ContextState& GetContextState()
+{
+    IM_ASSERT(GImGui != nullptr && "No current ImGui context.");
+    return GetContextState(*GImGui);
+}
+
+FrameArena& GetFrameArena()
+{
+    return GetContextState().frameArena;
+}
+
+MemoizedString& GetMemoizedString(ImGuiID key)
+{
+    return GetContextState().memoizedStrings[key];
+}
+
+PersistentCallback& GetPersistentCallback(ImGuiID key)
+{
+    return GetContextState().persistentCallbacks[key];
+}
+
+WidgetState& GetWidgetStateEntry(ImGuiID key)
+{
+    return GetContextState().widgetStates[key];
+}
+
+void EvictStaleWidgetStates(ContextState& state)
+{
+    const float timer = ImGui::GetIO().ConfigMemoryCompactTimer;
+    if (timer < 0.f || ImGui::GetFrameCount() % CacheEntryLifetime != 0)
+        return;
+
+    const double time = ImGui::GetTime();
+    std::erase_if(state.widgetStates, [&](const auto& kv) { return time - kv.second.lastTime > timer; });
+}
+
+void RecordElidedStylePushes(size_t count)
+{
+    GetContextState().currentFrameStats.elidedStylePushes += count;
+}
+
+// Runtime text shorter than this is measured directly, hashing and comparing it costs about as much as measuring it
+constexpr size_t MinCachedTextLength = 16;
+
+// Looks the text up by key, only building the stored key with makeKey on a miss
+template<typename Map, typename Key, typename MakeKey>
+ImVec2 FindOrMeasureText(Map& map, const Key& key, MakeKey makeKey, const char* text, const char* visibleEnd)
+{
+    ImGuiContext& g = *GImGui;
+    auto& stats = GetContextState(g).currentFrameStats;
+    auto it = map.find(key);
+    if (it == map.end())
+    {
+        it = map.emplace(makeKey(), TextSizeEntry{ ImGui::CalcTextSize(text, visibleEnd, false) }).first;
+        ++stats.textSizeCacheMisses;
+    }
+    else
+        ++stats.textSizeCacheHits;
+
+    it->second.lastFrame = g.FrameCount;
+    return it->second.size;
+}
+
+ImVec2 CalcLabelSize(const char* text, const char* textEnd)
+{
+    ImGuiContext& g = *GImGui;
+    const char* visibleEnd = ImGui::FindRenderedTextEnd(text, textEnd);
+    if (text == visibleEnd)
+        return ImVec2(0.f, g.FontSize);
+    if (static_cast<size_t>(visibleEnd - text) < MinCachedTextLength)
+        return ImGui::CalcTextSize(text, visibleEnd, false);
+
+    const TextSizeKeyView key{ g.Font, g.FontSize, { text, visibleEnd } };
+    const auto makeKey = [&] { return TextSizeKey{ key.font, key.fontSize, std::string(key.text) }; };
+    return FindOrMeasureText(GetContextState(g).textSizes, key, makeKey, text, visibleEnd);
+}
+
+ImVec2 CalcLabelSize(const Label& label)
+{
+    ImGuiContext& g = *GImGui;
+    if (label.GetValue() == label.GetVisibleEnd())
+        return ImVec2(0.f, g.FontSize);
+
+    const LabelSizeKey key{ g.Font, g.FontSize, label.GetValue(), static_cast<ImU32>(label.GetVisibleEnd() - label.GetValue()) };
+    return FindOrMeasureText(GetContextState(g).labelSizes, key, [&] { return key; }, label.GetValue(), label.GetVisibleEnd());
+}
+
+char ToLowerASCII(char c)
+{
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Packs a gram of 1 to 3 characters with its length in the top bits, so grams of different lengths never collide
+ImU32 PackGram(const char* text, size_t length)
+{
+    ImU32 key = static_cast<ImU32>(length) << 24;
+    for (size_t i = 0; i < length; ++i)
+        key |= ImU32(ImU8(text[i])) << (8 * (length - 1 - i));
+    return key;
+}
+
+void SearchIndex::Reset(size_t count)
+{
+    // Requests the stop and joins before the build's result is dropped
+    builder_ = {};
+    count_ = count;
+    labels_ = std::make_shared<Labels>();
+    labels_->ends.reserve(count);
+    grams_.reset();
+    pending_.reset();
+}
+
+void SearchIndex::AppendLabel(std::string_view label)
+{
+    label = label.substr(0, label.find("##"));
+    for (char c : label)
+        labels_->text.push_back(ToLowerASCII(c));
+
+    labels_->ends.push_back(static_cast<ImU32>(labels_->text.size()));
+}
+
+std::string_view SearchIndex::GetText(size_t i) const
+{
+    const auto& ends = labels_->ends;
+    const ImU32 begin = i == 0 ? 0 : ends[i - 1];
+    return std::string_view(labels_->text).substr(begin, ends[i] - begin);
+}
+
+void SearchIndex::StartGrams()
+{
+    if (labels_->text.size() <= SyncIndexSize)
+    {
+        grams_ = std::make_shared<const Grams>(*BuildGrams(*labels_, {}));
+        return;
+    }
+
+    // The worker only holds shared pointers to immutable labels and to its own result, Reset and the destructor stop and join it
+    pending_ = std::make_shared<PendingGrams>();
+    builder_ = std::jthread([labels = std::shared_ptr<const Labels>(labels_), pending = pending_](std::stop_token stop) {
+        auto grams = BuildGrams(*labels, stop);
+        if (!grams)
+            return;
+
+        auto result = std::make_shared<const Grams>(std::move(*grams));
+        std::lock_guard lock(pending->mutex);
+        pending->result = std::move(result);
+    });
+}
+
+bool SearchIndex::PollGrams()
+{
+    if (!pending_)
+        return false;
+
+    std::lock_guard lock(pending_->mutex);
+    if (!pending_->result)
+        return false;
+
+    grams_ = std::move(pending_->result);
+    return true;
+}
+
+std::optional<SearchIndex::Grams> SearchIndex::BuildGrams(const Labels& labels, std::stop_token stop)
+{
+    constexpr size_t StopCheckInterval = 1 << 16;
+
+    // (gram, label) pairs, generated label by label so that a stable sort on the gram alone groups them by gram, then by label
+    std::vector<ImU64> pairs;
+    pairs.reserve(labels.text.size() * 3);
+    for (size_t i = 0, begin = 0; i < labels.ends.size(); begin = labels.ends[i++])
+    {
+        if (i % StopCheckInterval == 0 && stop.stop_requested())
+            return std::nullopt;
+
+        for (size_t c = begin; c < labels.ends[i]; ++c)
+            for (size_t length = 1; length <= 3 && c + length <= labels.ends[i]; ++length)
+                pairs.push_back((ImU64(PackGram(labels.text.data() + c, length)) << 32) | i);
+    }
+
+    // Packed grams are 26 bits, sorted by two stable counting passes of 13 bits which, unlike std::sort, can stop partway
+    constexpr int DigitBits = 13;
+    std::vector<ImU64> sorted(pairs.size());
+    std::vector<size_t> offsets;
+    for (int shift = 32; shift < 32 + 2 * DigitBits; shift += DigitBits)
     {
-        Detail::callbacks.clear();
+        const auto digit = [shift](ImU64 pair) { return static_cast<size_t>(pair >> shift) & ((size_t(1) << DigitBits) - 1); };
+        offsets.assign((size_t(1) << DigitBits) + 1, 0);
+        for (ImU64 pair : pairs)
+            ++offsets[digit(pair) + 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        for (size_t p = 0; p < pairs.size(); ++p)
+        {
+            if (p % (StopCheckInterval * 16) == 0 && stop.stop_requested())
+                return std::nullopt;
+            sorted[offsets[digit(pairs[p])]++] = pairs[p];
+        }
+        pairs.swap(sorted);
+    }
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    Grams grams;
+    grams.postings.reserve(pairs.size());
+    for (ImU64 pair : pairs)
+    {
+        const ImU32 key = static_cast<ImU32>(pair >> 32);
+        if (grams.keys.empty() || grams.keys.back() != key)
+        {
+            grams.keys.push_back(key);
+            grams.starts.push_back(static_cast<ImU32>(grams.postings.size()));
+        }
+        grams.postings.push_back(static_cast<ImU32>(pair));
+    }
+    grams.starts.push_back(static_cast<ImU32>(grams.postings.size()));
+    return grams;
+}
+
+std::span<const ImU32> SearchIndex::FindPostings(std::string_view gram) const
+{
+    const auto& [keys, starts, postings] = *grams_;
+    const ImU32 key = PackGram(gram.data(), gram.size());
+    const auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key)
+        return {};
+
+    const size_t k = it - keys.begin();
+    return std::span(postings).subspan(starts[k], starts[k + 1] - starts[k]);
+}
+
+void SearchIndex::Query(std::string_view filter, std::vector<int>& results) const
+{
+    results.clear();
+
+    std::string needle(filter.size(), '\0');
+    std::transform(filter.begin(), filter.end(), needle.begin(), ToLowerASCII);
+
+    // Until the background build of a large list completes there are no grams at all
+    const size_t count = labels_->ends.size();
+    if (needle.empty() || !grams_)
+    {
+        for (size_t i = 0; i < count; ++i)
+            if (needle.empty() || GetText(i).find(needle) != std::string_view::npos)
+                results.push_back(static_cast<int>(i));
+        return;
+    }
+
+    // A label contains a filter of up to 3 characters exactly when the filter is one of its grams
+    if (needle.size() <= 3)
+    {
+        const auto list = FindPostings(needle);
+        results.assign(list.begin(), list.end());
+        return;
+    }
+
+    std::vector<std::span<const ImU32>> lists;
+    for (size_t c = 0; c + 3 <= needle.size(); ++c)
+    {
+        lists.push_back(FindPostings(std::string_view(needle).substr(c, 3)));
+        if (lists.back().empty())
+            return;
+    }
+
+    // Candidates come from the shortest list, every other list is probed with a search bounded by the previous hit since candidates are increasing
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+    std::vector<size_t> cursors(lists.size(), 0);
+    for (ImU32 candidate : lists.front())
+    {
+        bool inAll = true;
+        for (size_t l = 1; l < lists.size() && inAll; ++l)
+        {
+            const auto& list = lists[l];
+            cursors[l] = std::lower_bound(list.begin() + cursors[l], list.end(), candidate) - list.begin();
+            inAll = cursors[l] < list.size() && list[cursors[l]] == candidate;
+        }
+
+        if (inAll && GetText(candidate).find(needle) != std::string_view::npos)
+            results.push_back(static_cast<int>(candidate));
+    }
+}
+
+void PrefixSums::Assign(std::span<const float> values)
+{
+    tree_.assign(values.begin(), values.end());
+    for (size_t i = 1; i <= tree_.size(); ++i)
+    {
+        const size_t parent = i + (i & (~i + 1));
+        if (parent <= tree_.size())
+            tree_[parent - 1] += tree_[i - 1];
+    }
+}
+
+void PrefixSums::Append(float value)
+{
+    // The new node covers itself and the lowbit(n) - 1 values before it
+    const size_t n = tree_.size() + 1;
+    const size_t covered = n & (~n + 1);
+    tree_.push_back(value + Prefix(n - 1) - Prefix(n - covered));
+}
+
+void PrefixSums::Add(size_t index, float delta)
+{
+    for (size_t i = index + 1; i <= tree_.size(); i += i & (~i + 1))
+        tree_[i - 1] += delta;
+}
+
+double PrefixSums::Prefix(size_t count) const
+{
+    double sum = 0.0;
+    for (size_t i = count; i > 0; i &= i - 1)
+        sum += tree_[i - 1];
+    return sum;
+}
+
+size_t PrefixSums::Find(double offset) const
+{
+    size_t position = 0;
+    for (size_t step = std::bit_floor(tree_.size()); step > 0; step >>= 1)
+    {
+        if (position + step <= tree_.size() && tree_[position + step - 1] <= offset)
+        {
+            position += step;
+            offset -= tree_[position - 1];
+        }
+    }
+    return position;
+}
+
+void SortTableOrder(std::vector<ImU32>& order, bool (*less)(const void* context, ImU32 a, ImU32 b), const void* context)
+{
+    const auto compare = [&](ImU32 a, ImU32 b) { return less(context, a, b); };
+#if defined(NGUI_PARALLEL_SORT) && defined(__cpp_lib_parallel_algorithm)
+    std::stable_sort(std::execution::par, order.begin(), order.end(), compare);
+#else
+    std::stable_sort(order.begin(), order.end(), compare);
+#endif
+}
+
+void AddFrameHook(std::weak_ptr<FrameHook> hook)
+{
+    GetContextState().frameHooks.push_back(std::move(hook));
+}
+
+void RunFrameHooks(ContextState& state)
+{
+    std::erase_if(state.frameHooks, [](const std::weak_ptr<FrameHook>& hook) {
+        if (auto h = hook.lock())
+        {
+            h->OnNewFrame();
+            return false;
+        }
+        return true;
+    });
+}
+
+void UpdateTextSizeCache(ContextState& state)
+{
+    ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+    const FontAtlasSignature signature{ atlas, atlas->TexID, atlas->TexWidth, atlas->TexHeight, atlas->Fonts.Size };
+    if (signature != state.textSizesAtlas)
+    {
+        state.textSizes.clear();
+        state.labelSizes.clear();
+        state.textSizesAtlas = signature;
+    }
+    else
+    {
+        EvictStaleEntries(state.textSizes);
+        EvictStaleEntries(state.labelSizes);
+    }
+}
+
+}
+namespace NGui
+{
+    void NewFrame()
+    {
+        auto& state = Detail::GetContextState();
+
+        state.frameArena.Reset();
+        Detail::EvictStaleEntries(state.memoizedStrings);
+        Detail::EvictStaleEntries(state.persistentCallbacks);
+        Detail::EvictStaleWidgetStates(state);
+        Detail::UpdateTextSizeCache(state);
+        Detail::RunFrameHooks(state);
+
+        state.lastFrameStats = std::exchange(state.currentFrameStats, {});
+    }
+
+    const FrameStats& GetFrameStats()
+    {
+        return Detail::GetContextState().lastFrameStats;
+    }
+
+    void InvalidateTextSizeCache()
+    {
+        auto& state = Detail::GetContextState();
+        state.textSizes.clear();
+        state.labelSizes.clear();
+    }
+
+    void IndexSet::SetRange(size_t first, size_t last, bool present)
+    {
+        if (present && pages_.size() * PageBits < last)
+            pages_.resize((last + PageBits - 1) / PageBits);
+        last = std::min(last, pages_.size() * PageBits);
+        if (first >= last)
+            return;
+
+        const ImU32 target = present ? PageBits : 0;
+        for (size_t p = first / PageBits; p <= (last - 1) / PageBits; ++p)
+        {
+            Page& page = pages_[p];
+            const size_t begin = std::max(first, p * PageBits) - p * PageBits;
+            const size_t end = std::min(last, (p + 1) * PageBits) - p * PageBits;
+            if (page.count == target)
+                continue;
+
+            if (begin == 0 && end == PageBits)
+            {
+                size_ = size_ - page.count + target;
+                page.count = target;
+                page.bits.reset();
+                continue;
+            }
+
+            if (!page.bits)
+            {
+                page.bits = std::make_unique<ImU64[]>(PageBits / 64);
+                if (page.count == PageBits)
+                    std::fill_n(page.bits.get(), PageBits / 64, ~ImU64(0));
+            }
+
+            size_t changed = 0;
+            for (size_t word = begin / 64; word <= (end - 1) / 64; ++word)
+            {
+                const size_t lo = std::max(begin, word * 64) - word * 64;
+                const size_t hi = std::min(end, (word + 1) * 64) - word * 64;
+                const ImU64 mask = (hi == 64 ? ~ImU64(0) : (ImU64(1) << hi) - 1) & ~((ImU64(1) << lo) - 1);
+                const ImU64 bits = present ? page.bits[word] | mask : page.bits[word] & ~mask;
+                changed += std::popcount(bits ^ page.bits[word]);
+                page.bits[word] = bits;
+            }
+
+            page.count = present ? page.count + static_cast<ImU32>(changed) : page.count - static_cast<ImU32>(changed);
+            size_ = present ? size_ + changed : size_ - changed;
+            if (page.count == 0 || page.count == PageBits)
+                page.bits.reset();
+        }
+    }
+
+    void IndexSet::Clear()
+    {
+        pages_.clear();
+        size_ = 0;
+    }
+
+    bool IndexSet::ApplyRequests(const ImGuiMultiSelectIO& io, size_t itemCount)
+    {
+        for (const ImGuiSelectionRequest& request : io.Requests)
+        {
+            if (request.Type == ImGuiSelectionRequestType_SetAll)
+            {
+                if (request.Selected)
+                    SetRange(0, itemCount, true);
+                else
+                    Clear();
+            }
+            else if (request.Type == ImGuiSelectionRequestType_SetRange)
+                SetRange(static_cast<size_t>(request.RangeFirstItem), static_cast<size_t>(request.RangeLastItem) + 1, request.Selected);
+        }
+        return !io.Requests.empty();
+    }
+
+    Theme::Definition Theme::Definition::Capture(const ImGuiStyle& style)
+    {
+        Definition def;
+        for (int i = 0; i < ImGuiStyleVar_COUNT; ++i)
+        {
+            const auto* info = ImGui::GetStyleVarInfo(i);
+            const auto* value = static_cast<const float*>(info->GetVarPtr(const_cast<ImGuiStyle*>(&style)));
+            const ImU64 bit = ImU64(1) << i;
+
+            def.vars_[i].x = value[0];
+            def.varMaskX_ |= bit;
+            if (info->Count == 2)
+            {
+                def.vars_[i].y = value[1];
+                def.varMaskY_ |= bit;
+            }
+        }
+
+        std::copy(std::begin(style.Colors), std::end(style.Colors), def.colors_.begin());
+        def.colorMask_ = (ImU64(1) << ImGuiCol_COUNT) - 1;
+
+        return def;
+    }
+
+    size_t IdSet::Find(ImGuiID id) const
+    {
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = Home(id);; i = (i + 1) & mask)
+            if (slots_[i] == id || slots_[i] == 0)
+                return i;
+    }
+
+    bool IdSet::Contains(ImGuiID id) const
+    {
+        IM_ASSERT(id != 0);
+        return size_ > 0 && slots_[Find(id)] == id;
+    }
+
+    bool IdSet::Insert(ImGuiID id)
+    {
+        IM_ASSERT(id != 0);
+        if ((size_ + 1) * 2 > slots_.size())
+            Rehash(std::max<size_t>(slots_.size() * 2, 8));
+
+        ImGuiID& slot = slots_[Find(id)];
+        if (slot == id)
+            return false;
+
+        slot = id;
+        ++size_;
+        return true;
+    }
+
+    bool IdSet::Erase(ImGuiID id)
+    {
+        IM_ASSERT(id != 0);
+        if (size_ == 0)
+            return false;
+
+        size_t hole = Find(id);
+        if (slots_[hole] != id)
+            return false;
+
+        // Move back any later entry of the same probe run whose home is not between the hole and itself
+        const size_t mask = slots_.size() - 1;
+        for (size_t i = (hole + 1) & mask; slots_[i] != 0; i = (i + 1) & mask)
+        {
+            const size_t home = Home(slots_[i]);
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                slots_[hole] = slots_[i];
+                hole = i;
+            }
+        }
+
+        slots_[hole] = 0;
+        --size_;
+        return true;
+    }
+
+    bool IdSet::Toggle(ImGuiID id)
+    {
+        if (Erase(id))
+            return false;
+
+        Insert(id);
+        return true;
+    }
+
+    void IdSet::Clear()
+    {
+        std::fill(slots_.begin(), slots_.end(), 0);
+        size_ = 0;
+    }
+
+    void IdSet::Reserve(size_t count)
+    {
+        if (count * 2 > slots_.size())
+            Rehash(std::max<size_t>(std::bit_ceil(count * 2), 8));
+    }
+
+    void IdSet::Rehash(size_t capacity)
+    {
+        std::vector<ImGuiID> old = std::exchange(slots_, std::vector<ImGuiID>(capacity, 0));
+        shift_ = 32 - std::countr_zero(capacity);
+
+        for (ImGuiID id : old)
+            if (id != 0)
+                slots_[Find(id)] = id;
+    }
+
+    std::vector<ImU8> IdSet::Serialize() const
+    {
+        std::vector<ImGuiID> ids;
+        ids.reserve(size_);
+        ForEach([&](ImGuiID id) { ids.push_back(id); });
+        std::sort(ids.begin(), ids.end());
+
+        std::vector<ImU8> data;
+        data.reserve(ids.size() * 2 + 5);
+        const auto write = [&](ImU32 value) {
+            for (; value >= 0x80; value >>= 7)
+                data.push_back(static_cast<ImU8>(value | 0x80));
+            data.push_back(static_cast<ImU8>(value));
+        };
+
+        write(static_cast<ImU32>(ids.size()));
+        ImGuiID previous = 0;
+        for (ImGuiID id : ids)
+        {
+            write(id - previous);
+            previous = id;
+        }
+
+        return data;
+    }
+
+    bool IdSet::Deserialize(std::span<const ImU8> data)
+    {
+        Clear();
+
+        size_t offset = 0;
+        const auto read = [&](ImU32& value) {
+            value = 0;
+            for (int shift = 0; shift < 35 && offset < data.size(); shift += 7)
+            {
+                const ImU8 byte = data[offset++];
+                if (shift == 28 && (byte & 0x70))
+                    return false; // Bits past 32
+                value |= static_cast<ImU32>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        };
+
+        ImU32 count;
+        if (!read(count) || count > data.size())
+            return false;
+
+        Reserve(count);
+        ImGuiID id = 0;
+        for (ImU32 i = 0; i < count; ++i)
+        {
+            ImU32 delta;
+            // IDs are strictly increasing and non-zero, and must not wrap around
+            if (!read(delta) || delta == 0 || delta > std::numeric_limits<ImU32>::max() - id)
+            {
+                Clear();
+                return false;
+            }
+
+            id += delta;
+            Insert(id);
+        }
+
+        return true;
+    }
+
+    void Theme::Apply(const Definition& def) const
+    {
+        ImGuiStyle& style = ImGui::GetStyle();
+
+        for (ImU64 mask = def.varMaskX_ | def.varMaskY_; mask != 0; mask &= mask - 1)
+        {
+            const int i = std::countr_zero(mask);
+            const ImU64 bit = ImU64(1) << i;
+            auto* value = static_cast<float*>(ImGui::GetStyleVarInfo(i)->GetVarPtr(&style));
+
+            if (def.varMaskX_ & bit)
+                value[0] = def.vars_[i].x;
+            if (def.varMaskY_ & bit)
+                value[1] = def.vars_[i].y;
+        }
+
+        constexpr ImU64 allColors = (ImU64(1) << ImGuiCol_COUNT) - 1;
+        if (def.colorMask_ == allColors)
+            std::copy(def.colors_.begin(), def.colors_.end(), std::begin(style.Colors));
+        else
+        {
+            for (ImU64 mask = def.colorMask_; mask != 0; mask &= mask - 1)
+            {
+                const int i = std::countr_zero(mask);
+                style.Colors[i] = def.colors_[i];
+            }
+        }
+    }
+}
+
+namespace NGui::Detail
+{
+    // Read-only file handle which can map or read its current contents
+    class MappedFile
+    {
+    public:
+        // View of the first bytes of the file, unmapped on destruction
+        class View
+        {
+        public:
+            View() = default;
+            View(View&& other) noexcept { *this = std::move(other); }
+            View& operator=(View&& other) noexcept
+            {
+                std::swap(data_, other.data_);
+                std::swap(size_, other.size_);
+#ifdef _WIN32
+                std::swap(mapping_, other.mapping_);
+#endif
+                return *this;
+            }
+            ~View()
+            {
+#ifdef _WIN32
+                if (data_)
+                    UnmapViewOfFile(data_);
+                if (mapping_)
+                    CloseHandle(mapping_);
+#else
+                if (data_)
+                    munmap(const_cast<char*>(data_), size_);
+#endif
+            }
+
+            [[nodiscard]] std::span<const char> GetData() const { return { data_, size_ }; }
+
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+#ifdef _WIN32
+            HANDLE mapping_ = nullptr;
+#endif
+            friend class MappedFile;
+        };
+
+        explicit MappedFile(const std::filesystem::path& path)
+        {
+#ifdef _WIN32
+            file_ = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+#else
+            file_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+        }
+
+        // Identifies the file itself rather than its path, a rotated log gets a new one
+        struct Id
+        {
+            ImU64 device = 0;
+            ImU64 index = 0;
+            bool operator==(const Id&) const = default;
+        };
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept
+        {
+            std::swap(file_, other.file_);
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            if (!IsOpen())
+                return;
+#ifdef _WIN32
+            CloseHandle(file_);
+#else
+            close(file_);
+#endif
+        }
+
+        [[nodiscard]] bool IsOpen() const
+        {
+#ifdef _WIN32
+            return file_ != INVALID_HANDLE_VALUE;
+#else
+            return file_ >= 0;
+#endif
+        }
+
+        [[nodiscard]] size_t GetSize() const
+        {
+#ifdef _WIN32
+            LARGE_INTEGER size;
+            return IsOpen() && GetFileSizeEx(file_, &size) ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+            struct stat st;
+            return IsOpen() && fstat(file_, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+#endif
+        }
+
+        [[nodiscard]] Id GetId() const
+        {
+#ifdef _WIN32
+            BY_HANDLE_FILE_INFORMATION info;
+            if (!IsOpen() || !GetFileInformationByHandle(file_, &info))
+                return {};
+            return { info.dwVolumeSerialNumber, (ImU64(info.nFileIndexHigh) << 32) | info.nFileIndexLow };
+#else
+            struct stat st;
+            if (!IsOpen() || fstat(file_, &st) != 0)
+                return {};
+            return { static_cast<ImU64>(st.st_dev), static_cast<ImU64>(st.st_ino) };
+#endif
+        }
+
+        // Reads up to out.size() bytes from offset, returns the number read, 0 at the end of the file or on error
+        [[nodiscard]] size_t Read(ImU64 offset, std::span<char> out) const
+        {
+            if (!IsOpen())
+                return 0;
+#ifdef _WIN32
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            DWORD read = 0;
+            return ReadFile(file_, out.data(), static_cast<DWORD>(std::min<size_t>(out.size(), MAXDWORD)), &read, &overlapped) ? read : 0;
+#else
+            const ssize_t read = pread(file_, out.data(), out.size(), static_cast<off_t>(offset));
+            return read > 0 ? static_cast<size_t>(read) : 0;
+#endif
+        }
+
+        // Maps the first size bytes, an empty view if size is 0 or mapping failed
+        [[nodiscard]] View Map(size_t size) const
+        {
+            View view;
+            if (!IsOpen() || size == 0)
+                return view;
+
+#ifdef _WIN32
+            view.mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, static_cast<DWORD>(ImU64(size) >> 32), static_cast<DWORD>(size), nullptr);
+            if (!view.mapping_)
+                return view;
+
+            view.data_ = static_cast<const char*>(MapViewOfFile(view.mapping_, FILE_MAP_READ, 0, 0, size));
+#else
+            void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file_, 0);
+            view.data_ = data == MAP_FAILED ? nullptr : static_cast<const char*>(data);
+#endif
+            if (view.data_)
+                view.size_ = size;
+            return view;
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE file_ = INVALID_HANDLE_VALUE;
+#else
+        int file_ = -1;
+#endif
+    };
+}
+
+namespace NGui
+{
+    struct TextDocument::Impl
+    {
+        // Bytes scanned between two publications of new lines, and read from a followed file at once
+        static constexpr size_t ChunkSize = 4 << 20;
+        // Capacity of the chunks holding a followed file
+        static constexpr size_t OwnedChunkSize = 16 << 20;
+        // Lines per block of line starts, stored relative to the block's first line
+        static constexpr size_t BlockLines = 4096;
+        static constexpr auto FollowInterval = std::chrono::milliseconds(250);
+
+        struct Block
+        {
+            ImU64 base;
+            size_t firstLine;
+        };
+
+        // Contiguous run of the text. A mapped file or caller-owned text is a single chunk; a followed file is read into owned chunks, which
+        // always end after a newline once full so that every line lies within one chunk.
+        struct Chunk
+        {
+            ImU64 base; // Offset of the first byte in the document
+            const char* data = nullptr;
+            size_t size = 0;
+            std::unique_ptr<char[]> owned;
+            size_t capacity = 0;
+        };
+
+        // Guards the text and line starts: the indexer only takes it exclusively to publish text or lines, readers hold it shared while drawing
+        mutable std::shared_mutex mutex;
+        std::optional<Detail::MappedFile> file;
+        std::filesystem::path path;
+        Detail::MappedFile::View view;
+        std::vector<Chunk> chunks;
+        ImU64 size = 0;
+        std::vector<Block> blocks;
+        std::vector<ImU32> lineStarts;
+        ImU64 indexedSize = 0;
+        bool follow = false;
+        bool open = true;
+
+        std::mutex wakeMutex;
+        std::condition_variable_any wake;
+        std::jthread indexer; // Last, so the thread is stopped before anything it uses is destroyed
+
+        void AddLineStart(ImU64 start)
+        {
+            if (blocks.empty() || lineStarts.size() - blocks.back().firstLine >= BlockLines || start - blocks.back().base > std::numeric_limits<ImU32>::max())
+                blocks.push_back({ start, lineStarts.size() });
+            lineStarts.push_back(static_cast<ImU32>(start - blocks.back().base));
+        }
+
+        ImU64 GetLineStart(size_t line) const
+        {
+            const auto block = std::prev(std::upper_bound(blocks.begin(), blocks.end(), line, [](size_t l, const Block& b) { return l < b.firstLine; }));
+            return block->base + lineStarts[line];
+        }
+
+        // Lines with content, a final empty line after a trailing newline is not counted
+        size_t GetLineCount() const
+        {
+            if (lineStarts.empty())
+                return 0;
+            return GetLineStart(lineStarts.size() - 1) == indexedSize ? lineStarts.size() - 1 : lineStarts.size();
+        }
+
+        // Chunk holding the byte at offset, or the last chunk if offset is the end of the text
+        const Chunk& FindChunk(ImU64 offset) const
+        {
+            return *std::prev(std::upper_bound(chunks.begin() + 1, chunks.end(), offset, [](ImU64 o, const Chunk& c) { return o < c.base; }));
+        }
+
+        std::string_view GetLine(size_t line) const
+        {
+            const ImU64 begin = GetLineStart(line);
+            ImU64 end = line + 1 < lineStarts.size() ? GetLineStart(line + 1) - 1 : indexedSize;
+            const Chunk& chunk = FindChunk(begin);
+            const char* data = chunk.data + (begin - chunk.base);
+            if (end > begin && data[end - begin - 1] == '\r')
+                --end;
+            return { data, static_cast<size_t>(end - begin) };
+        }
+
+        void Start()
+        {
+            indexer = std::jthread([this](std::stop_token stop) { Run(stop); });
+        }
+
+        void Run(std::stop_token stop)
+        {
+            while (!stop.stop_requested())
+            {
+                if (IndexChunk() || (follow && ReadAppended()))
+                    continue;
+
+                // Caught up: wait for Extend(), or poll the file for appended bytes
+                std::unique_lock lock(wakeMutex);
+                if (follow)
+                {
+                    wake.wait_for(lock, stop, FollowInterval, [] { return false; });
+                    lock.unlock();
+                    CheckReplaced();
+                }
+                else
+                    wake.wait(lock, stop, [&] { std::shared_lock textLock(mutex); return indexedSize < size; });
+            }
+        }
+
+        // Indexes the next chunk of text and publishes its lines, false if everything was already indexed.
+        // Only the indexer changes the chunks of a file, caller-owned text is only replaced under the exclusive lock, so the scan holds the lock shared.
+        bool IndexChunk()
+        {
+            std::vector<ImU64> starts;
+            ImU64 end;
+            {
+                std::shared_lock lock(mutex);
+                const ImU64 begin = indexedSize;
+                if (begin == size)
+                    return false;
+
+                const Chunk& chunk = FindChunk(begin);
+                end = std::min(chunk.base + chunk.size, begin + ChunkSize);
+                if (begin == 0)
+                    starts.push_back(0);
+                const char* last = chunk.data + (end - chunk.base);
+                for (const char* c = chunk.data + (begin - chunk.base); (c = static_cast<const char*>(std::memchr(c, '\n', last - c))) != nullptr;)
+                    starts.push_back(chunk.base + static_cast<ImU64>(++c - chunk.data));
+            }
+
+            std::unique_lock lock(mutex);
+            for (ImU64 start : starts)
+                AddLineStart(start);
+            indexedSize = end;
+            return true;
+        }
+
+        /**
+         * Reads bytes appended to a followed file into the last chunk, false if there were none.
+         * A followed file is never mapped: a writer truncating it (copytruncate rotation) would turn reads of the mapping into SIGBUS on POSIX,
+         * and on Windows a mapping prevents the writer from truncating its own file at all.
+        */
+        bool ReadAppended()
+        {
+            const ImU64 fileSize = file->GetSize();
+            if (fileSize <= size)
+                return false;
+
+            const size_t wanted = static_cast<size_t>(std::min<ImU64>(fileSize - size, ChunkSize));
+            if (chunks.empty() || chunks.back().capacity - chunks.back().size < wanted)
+                StartChunk(wanted);
+
+            // Readers never look past the published size, so the read needs no lock
+            Chunk& chunk = chunks.back();
+            const size_t read = file->Read(size, { chunk.owned.get() + chunk.size, wanted });
+            if (read == 0)
+                return false;
+
+            std::unique_lock lock(mutex);
+            chunk.size += read;
+            size += read;
+            return true;
+        }
+
+        // Starts a chunk with room for wanted more bytes, moving the unterminated last line of the current one into it
+        void StartChunk(size_t wanted)
+        {
+            size_t tail = 0;
+            if (!chunks.empty())
+            {
+                const Chunk& last = chunks.back();
+                const char* end = last.data + last.size;
+                const char* lineStart = end;
+                while (lineStart != last.data && lineStart[-1] != '\n')
+                    --lineStart;
+                tail = static_cast<size_t>(end - lineStart);
+            }
+
+            // Doubled past OwnedChunkSize so a single very long line is not copied again on every read
+            Chunk chunk{ size - tail };
+            chunk.capacity = std::max(OwnedChunkSize, 2 * (tail + wanted));
+            chunk.owned = std::make_unique_for_overwrite<char[]>(chunk.capacity);
+            chunk.data = chunk.owned.get();
+            chunk.size = tail;
+            if (tail > 0)
+                std::memcpy(chunk.owned.get(), chunks.back().data + chunks.back().size - tail, tail);
+
+            std::unique_lock lock(mutex);
+            if (!chunks.empty() && chunks.back().size == tail)
+                chunks.pop_back();
+            else if (!chunks.empty())
+                chunks.back().size -= tail;
+            chunks.push_back(std::move(chunk));
+        }
+
+        // Starts over from an empty document if the followed file was truncated, or another file was rotated in at its path
+        void CheckReplaced()
+        {
+            Detail::MappedFile current(path);
+            const bool rotated = current.IsOpen() && current.GetId() != file->GetId();
+            if (!rotated && file->GetSize() >= size)
+                return;
+
+            if (rotated)
+                *file = std::move(current);
+
+            std::unique_lock lock(mutex);
+            chunks.clear();
+            size = 0;
+            blocks.clear();
+            lineStarts.clear();
+            indexedSize = 0;
+        }
+    };
+
+    TextDocument::TextDocument(const std::filesystem::path& path, bool follow)
+        : impl_(std::make_unique<Impl>())
+    {
+        impl_->file.emplace(path);
+        impl_->path = path;
+        impl_->follow = follow;
+        impl_->open = impl_->file->IsOpen();
+        if (!impl_->open)
+            return;
+
+        if (!follow)
+        {
+            const size_t size = impl_->file->GetSize();
+            impl_->view = impl_->file->Map(size);
+            impl_->open = size == 0 || !impl_->view.GetData().empty();
+            impl_->chunks.push_back({ 0, impl_->view.GetData().data(), impl_->view.GetData().size() });
+            impl_->size = impl_->view.GetData().size();
+        }
+        if (impl_->open)
+            impl_->Start();
+    }
+
+    TextDocument::TextDocument(TextInMemoryT, std::span<const char> text)
+        : impl_(std::make_unique<Impl>())
+    {
+        impl_->chunks.push_back({ 0, text.data(), text.size() });
+        impl_->size = text.size();
+        impl_->Start();
+    }
+
+    TextDocument::~TextDocument() = default;
+
+    void TextDocument::Extend(std::span<const char> text)
+    {
+        IM_ASSERT(!impl_->file && "Only caller-owned text can be extended.");
+        {
+            std::unique_lock lock(impl_->mutex);
+            IM_ASSERT(text.size() >= impl_->size);
+            impl_->chunks[0].data = text.data();
+            impl_->chunks[0].size = text.size();
+            impl_->size = text.size();
+        }
+        {
+            std::lock_guard lock(impl_->wakeMutex);
+        }
+        impl_->wake.notify_one();
+    }
+
+    bool TextDocument::IsOpen() const
+    {
+        return impl_->open;
+    }
+
+    size_t TextDocument::GetSize() const
+    {
+        std::shared_lock lock(impl_->mutex);
+        return static_cast<size_t>(impl_->size);
+    }
+
+    size_t TextDocument::GetIndexedSize() const
+    {
+        std::shared_lock lock(impl_->mutex);
+        return static_cast<size_t>(impl_->indexedSize);
+    }
+
+    size_t TextDocument::GetLineCount() const
+    {
+        std::shared_lock lock(impl_->mutex);
+        return impl_->GetLineCount();
+    }
+
+    void TextViewT::operator()(FormatArgs id, TextDocument& document, const Params& params) const
+    {
+        if (ImGui::BeginChild(id.GetValue(), params.size, params.childFlags, params.flags))
+        {
+            const auto& impl = *document.impl_;
+            const bool atBottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+
+            std::shared_lock lock(impl.mutex);
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(std::min<size_t>(impl.GetLineCount(), std::numeric_limits<int>::max())));
+            while (clipper.Step())
+            {
+                for (int line = clipper.DisplayStart; line < clipper.DisplayEnd; ++line)
+                {
+                    const std::string_view text = impl.GetLine(static_cast<size_t>(line)).substr(0, params.maxLineLength);
+                    ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                }
+            }
+            lock.unlock();
+
+            if (params.follow && atBottom)
+                ImGui::SetScrollHereY(1.f);
+        }
+        ImGui::EndChild();
+    }
+}
+
+namespace NGui::Detail
+{
+    // Filtered view of a LogBuffer, matches are kept as line serials so dropping old lines does not invalidate them.
+    // Without a filter every line shows and rows index the buffer directly, so matches stays empty.
+    struct LogConsoleState
+    {
+        // Lines filtered per frame, longer rescans after a filter change continue over the next frames
+        static constexpr size_t ScanBudget = 1 << 18;
+
+        ImGuiTextFilter filter;
+        int minSeverity = 0;
+        const void* buffer = nullptr; // Buffer whose line serials matches holds
+        std::deque<ImU64> matches;
+        ImU64 scanned = 0;
+    };
+}
+
+namespace NGui
+{
+    struct LogBuffer::Impl : Detail::FrameHook
+    {
+        static constexpr size_t ChunkSize = 256 << 10;
+
+        /**
+         * Bounded multi-producer ring (Vyukov): each slot's sequence tells whether it is free for the producer claiming position pos (== pos) or
+         * holds a record for the consumer (== pos + 1). Producers only contend on the enqueue position, the single consumer owns the dequeue position.
+        */
+        struct alignas(64) Slot
+        {
+            std::atomic<size_t> sequence;
+            ImS64 time;
+            LogSeverity severity;
+            ImU8 length;
+            char text[MaxRecordLength];
+        };
+        static_assert(MaxRecordLength <= std::numeric_limits<decltype(Slot::length)>::max());
+
+        struct Line
+        {
+            const char* text;
+            ImU32 length;
+            LogSeverity severity;
+            float time;
+        };
+
+        struct Chunk
+        {
+            std::unique_ptr<char[]> text;
+            size_t used = 0;
+            size_t lineCount = 0;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        size_t mask;
+        alignas(64) std::atomic<size_t> enqueuePos = 0;
+        alignas(64) std::atomic<size_t> dropped = 0;
+        alignas(64) size_t dequeuePos = 0;
+
+        // Owned by the UI thread
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const size_t maxLines;
+        std::deque<Line> lines;
+        std::deque<Chunk> chunks;
+        std::unique_ptr<char[]> spareChunk;
+        ImU64 firstSerial = 0;
+        ImGuiContext* context = nullptr;
+
+        explicit Impl(const Params& params)
+            : mask(std::bit_ceil(std::max<size_t>(params.capacity, 2)) - 1), maxLines(params.maxLines)
+        {
+            slots = std::make_unique<Slot[]>(mask + 1);
+            for (size_t i = 0; i <= mask; ++i)
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        bool Push(LogSeverity severity, std::string_view text)
+        {
+            size_t pos = enqueuePos.load(std::memory_order_relaxed);
+            Slot* slot;
+            for (;;)
+            {
+                slot = &slots[pos & mask];
+                const auto diff = static_cast<std::ptrdiff_t>(slot->sequence.load(std::memory_order_acquire) - pos);
+                if (diff == 0)
+                {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                else
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+
+            slot->time = std::chrono::steady_clock::now().time_since_epoch().count();
+            slot->severity = severity;
+            slot->length = static_cast<ImU8>(std::min(text.size(), MaxRecordLength));
+            std::memcpy(slot->text, text.data(), slot->length);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Moves everything published so far to the line store; bounded by the ring's capacity, since producers cannot get further ahead
+        void OnNewFrame() override
+        {
+            for (size_t count = 0; count <= mask; ++count)
+            {
+                Slot& slot = slots[dequeuePos & mask];
+                if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+                    break;
+
+                const std::chrono::steady_clock::duration time(slot.time);
+                Append(slot.severity, { slot.text, slot.length }, std::chrono::duration<float>(time - start.time_since_epoch()).count());
+                slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+                ++dequeuePos;
+            }
+            Compact();
+        }
+
+        void Append(LogSeverity severity, std::string_view text, float time)
+        {
+            if (chunks.empty() || chunks.back().used + text.size() > ChunkSize)
+                chunks.push_back({ spareChunk ? std::move(spareChunk) : std::make_unique<char[]>(ChunkSize) });
+
+            Chunk& chunk = chunks.back();
+            char* dest = chunk.text.get() + chunk.used;
+            std::memcpy(dest, text.data(), text.size());
+            chunk.used += text.size();
+            ++chunk.lineCount;
+            lines.push_back({ dest, static_cast<ImU32>(text.size()), severity, time });
+        }
+
+        // Drops whole chunks of old lines, keeping one chunk's memory for reuse
+        void Compact()
+        {
+            while (lines.size() > maxLines && chunks.size() > 1)
+            {
+                const size_t count = chunks.front().lineCount;
+                lines.erase(lines.begin(), lines.begin() + count);
+                firstSerial += count;
+                spareChunk = std::move(chunks.front().text);
+                chunks.pop_front();
+            }
+        }
+
+        void Register(const std::shared_ptr<Impl>& self)
+        {
+            if (context == GImGui)
+                return;
+
+            IM_ASSERT(context == nullptr && "A LogBuffer can only be drained by one ImGui context.");
+            context = GImGui;
+            Detail::AddFrameHook(self);
+        }
+    };
+
+    LogBuffer::LogBuffer(const Params& params)
+        : impl_(std::make_shared<Impl>(params))
+    {
+        if (GImGui)
+            impl_->Register(impl_);
+    }
+
+    LogBuffer::~LogBuffer() = default;
+
+    bool LogBuffer::Push(LogSeverity severity, std::string_view text)
+    {
+        return impl_->Push(severity, text);
+    }
+
+    void LogBuffer::Clear()
+    {
+        impl_->firstSerial += impl_->lines.size();
+        impl_->lines.clear();
+        if (!impl_->chunks.empty())
+            impl_->spareChunk = std::move(impl_->chunks.back().text);
+        impl_->chunks.clear();
+    }
+
+    size_t LogBuffer::GetLineCount() const
+    {
+        return impl_->lines.size();
+    }
+
+    size_t LogBuffer::GetDroppedCount() const
+    {
+        return impl_->dropped.load(std::memory_order_relaxed);
+    }
+
+    void LogConsoleT::operator()(FormatArgs id, LogBuffer& buffer, const Params& params) const
+    {
+        static constexpr const char* SeverityNames[] = { "Trace", "Debug", "Info", "Warning", "Error" };
+        static constexpr ImVec4 SeverityColors[] = { { 0.5f, 0.5f, 0.5f, 1.f }, { 0.7f, 0.7f, 0.7f, 1.f }, {}, { 1.f, 0.8f, 0.3f, 1.f }, { 1.f, 0.4f, 0.4f, 1.f } };
+
+        auto& impl = *buffer.impl_;
+        impl.Register(buffer.impl_);
+
+        const ImGuiID consoleId = ImGui::GetID(id.GetValue());
+        auto& state = Detail::GetWidgetState<Detail::LogConsoleState>(consoleId);
+        ImGui::PushID(consoleId);
+
+        if (params.toolbar)
+        {
+            bool changed = false;
+            ImGui::SetNextItemWidth(ImGui::GetFontSize() * 6.f);
+            changed |= ImGui::Combo("##severity", &state.minSeverity, SeverityNames, IM_ARRAYSIZE(SeverityNames));
+            ImGui::SameLine();
+            changed |= state.filter.Draw("##filter", ImGui::GetFontSize() * 16.f);
+            ImGui::SameLine();
+            if (ImGui::Button("Clear"))
+                buffer.Clear();
+            if (const size_t dropped = buffer.GetDroppedCount(); dropped > 0)
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("%zu dropped", dropped);
+            }
+
+            if (changed)
+            {
+                state.matches.clear();
+                state.scanned = 0;
+            }
+        }
+
+        // Serials are only meaningful for the buffer they were scanned from, e.g. when one console switches between sources
+        if (state.buffer != &impl)
+        {
+            state.buffer = &impl;
+            state.matches.clear();
+            state.scanned = 0;
+        }
+
+        const bool filtered = state.minSeverity > 0 || state.filter.IsActive();
+        if (!filtered)
+        {
+            state.matches.clear();
+            state.scanned = 0;
+        }
+        else
+        {
+            while (!state.matches.empty() && state.matches.front() < impl.firstSerial)
+                state.matches.pop_front();
+            state.scanned = std::max(state.scanned, impl.firstSerial);
+
+            const ImU64 end = impl.firstSerial + impl.lines.size();
+            for (size_t budget = Detail::LogConsoleState::ScanBudget; state.scanned < end && budget > 0; ++state.scanned, --budget)
+            {
+                const auto& line = impl.lines[state.scanned - impl.firstSerial];
+                if (static_cast<int>(line.severity) >= state.minSeverity && state.filter.PassFilter(line.text, line.text + line.length))
+                    state.matches.push_back(state.scanned);
+            }
+        }
+
+        if (ImGui::BeginChild("##lines", params.size, params.childFlags, ImGuiWindowFlags_HorizontalScrollbar))
+        {
+            const bool atBottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(filtered ? state.matches.size() : impl.lines.size()));
+            while (clipper.Step())
+            {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row)
+                {
+                    const auto& line = impl.lines[filtered ? state.matches[row] - impl.firstSerial : row];
+                    if (params.timestamps)
+                    {
+                        ImGui::TextDisabled("%10.3f", line.time);
+                        ImGui::SameLine();
+                    }
+
+                    const auto severity = static_cast<size_t>(line.severity);
+                    const bool colored = severity < IM_ARRAYSIZE(SeverityColors) && SeverityColors[severity].w > 0.f;
+                    if (colored)
+                        ImGui::PushStyleColor(ImGuiCol_Text, SeverityColors[severity]);
+                    ImGui::TextUnformatted(line.text, line.text + line.length);
+                    if (colored)
+                        ImGui::PopStyleColor();
+                }
+            }
+
+            if (params.follow && atBottom)
+                ImGui::SetScrollHereY(1.f);
+        }
+        ImGui::EndChild();
+
+        ImGui::PopID();
+    }
+}
+
+namespace NGui::Detail
+{
+    template<typename T>
+    void ReduceMinMaxScalar(const T* samples, size_t count, float& min, float& max)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float v = static_cast<float>(samples[i]);
+            min = std::min(min, v);
+            max = std::max(max, v);
+        }
+    }
+
+    void ReduceMinMax(const float* samples, size_t count, float& min, float& max)
+    {
+#ifdef NGUI_SSE2
+        __m128 mins = _mm_set1_ps(min), maxs = _mm_set1_ps(max);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(samples + i);
+            mins = _mm_min_ps(mins, v);
+            maxs = _mm_max_ps(maxs, v);
+        }
+
+        alignas(16) float lanes[2][4];
+        _mm_store_ps(lanes[0], mins);
+        _mm_store_ps(lanes[1], maxs);
+        min = std::min({ lanes[0][0], lanes[0][1], lanes[0][2], lanes[0][3] });
+        max = std::max({ lanes[1][0], lanes[1][1], lanes[1][2], lanes[1][3] });
+        ReduceMinMaxScalar(samples + i, count - i, min, max);
+#else
+        ReduceMinMaxScalar(samples, count, min, max);
+#endif
+    }
+
+    void ReduceMinMax(const double* samples, size_t count, float& min, float& max)
+    {
+#ifdef NGUI_SSE2
+        __m128d mins = _mm_set1_pd(min), maxs = _mm_set1_pd(max);
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const __m128d v = _mm_loadu_pd(samples + i);
+            mins = _mm_min_pd(mins, v);
+            maxs = _mm_max_pd(maxs, v);
+        }
+
+        alignas(16) double lanes[2][2];
+        _mm_store_pd(lanes[0], mins);
+        _mm_store_pd(lanes[1], maxs);
+        min = static_cast<float>(std::min(lanes[0][0], lanes[0][1]));
+        max = static_cast<float>(std::max(lanes[1][0], lanes[1][1]));
+        ReduceMinMaxScalar(samples + i, count - i, min, max);
+#else
+        ReduceMinMaxScalar(samples, count, min, max);
+#endif
+    }
+
+    struct PlotState
+    {
+        MinMaxPyramid pyramid;
+        size_t version = 0;
+        size_t count = 0;
+        // View in samples, everything unless zoomed
+        bool zoomed = false;
+        double begin = 0.0;
+        double end = 0.0;
+        std::vector<ImVec2> points;
+    };
+
+    template<typename T>
+    void DrawPlot(FormatArgs label, std::span<const T> samples, const PlotT::Params& params)
+    {
+        using namespace ImGui;
+
+        ImGuiWindow* window = GetCurrentWindow();
+        if (window->SkipItems)
+            return;
+
+        const ImGuiStyle& style = GetStyle();
+        const ImGuiID id = window->GetID(label.GetValue());
+        const char* labelEnd = FindRenderedTextEnd(label.GetValue());
+        const ImVec2 labelSize = CalcLabelSize(label.GetValue(), labelEnd);
+
+        const ImVec2 frameSize = CalcItemSize(params.size, CalcItemWidth(), labelSize.y + style.FramePadding.y * 2.f);
+        const ImRect frame(window->DC.CursorPos, window->DC.CursorPos + frameSize);
+        const ImRect inner(frame.Min + style.FramePadding, frame.Max - style.FramePadding);
+        const ImRect total(frame.Min, frame.Max + ImVec2(labelSize.x > 0.f ? style.ItemInnerSpacing.x + labelSize.x : 0.f, 0.f));
+        ItemSize(total, style.FramePadding.y);
+        if (!ItemAdd(total, id, &frame, ImGuiItemFlags_NoNav))
+            return;
+
+        bool hovered, held;
+        ButtonBehavior(frame, id, &hovered, &held);
+
+        auto& state = GetWidgetState<PlotState>(id);
+        if (state.version != params.version || samples.size() < state.count)
+        {
+            state.pyramid.Clear();
+            state.version = params.version;
+            state.zoomed = false;
+        }
+        state.pyramid.Update(samples);
+
+        // Keep following appended samples while the view ends on the newest ones
+        const double count = static_cast<double>(samples.size());
+        if (state.zoomed && state.end >= static_cast<double>(state.count))
+        {
+            state.begin += count - static_cast<double>(state.count);
+            state.end = count;
+        }
+        state.count = samples.size();
+
+        const float width = inner.GetWidth();
+        const ImGuiIO& io = GetIO();
+        const bool zoomable = hovered && width > 0.f && count >= 2.0;
+        // Claimed on every hovered frame, not just once the wheel moves, so the window never scrolls on the first wheel event either
+        if (zoomable)
+            SetItemKeyOwner(ImGuiKey_MouseWheelY);
+        if (zoomable && (io.MouseWheel != 0.f || (held && io.MouseDelta.x != 0.f)))
+        {
+            double begin = state.zoomed ? state.begin : 0.0, span = (state.zoomed ? state.end : count) - begin;
+            if (io.MouseWheel != 0.f)
+            {
+                const double pivot = begin + span * ImSaturate((io.MousePos.x - inner.Min.x) / width);
+                const double newSpan = ImClamp(span * std::pow(0.8, io.MouseWheel), std::min(count, 2.0), count);
+                begin = pivot - (pivot - begin) * newSpan / span;
+                span = newSpan;
+            }
+            if (held)
+                begin -= io.MouseDelta.x / width * span;
+
+            state.begin = ImClamp(begin, 0.0, count - span);
+            state.end = state.begin + span;
+            state.zoomed = span < count;
+        }
+        if (hovered && IsMouseDoubleClicked(ImGuiMouseButton_Left))
+            state.zoomed = false;
+
+        const double begin = state.zoomed ? state.begin : 0.0, end = state.zoomed ? state.end : count;
+        RenderFrame(frame.Min, frame.Max, GetColorU32(ImGuiCol_FrameBg), true, style.FrameRounding);
+
+        const auto first = static_cast<size_t>(begin), last = std::min(samples.size(), static_cast<size_t>(std::ceil(end)));
+        const int columns = static_cast<int>(width);
+        if (first < last && columns > 0)
+        {
+            float min = params.min.value_or(FLT_MAX), max = params.max.value_or(-FLT_MAX);
+            if (!params.min || !params.max)
+            {
+                const ImVec2 range = state.pyramid.Query(samples, first, last);
+                min = params.min.value_or(range.x);
+                max = params.max.value_or(range.y);
+            }
+            if (max - min <= 0.f)
+            {
+                min -= 0.5f;
+                max += 0.5f;
+            }
+
+            const auto toY = [&](float v) { return inner.Max.y - ImSaturate((v - min) / (max - min)) * inner.GetHeight(); };
+            const double samplesPerColumn = (end - begin) / columns;
+            state.points.clear();
+            if (samplesPerColumn <= 1.0)
+            {
+                // Zoomed in past one sample per pixel, connect the samples themselves including the ones just outside the view
+                for (size_t i = first > 0 ? first - 1 : 0; i < std::min(samples.size(), last + 1); ++i)
+                    state.points.push_back({ inner.Min.x + static_cast<float>((static_cast<double>(i) - begin) / samplesPerColumn), toY(static_cast<float>(samples[i])) });
+            }
+            else
+            {
+                for (int c = 0; c < columns; ++c)
+                {
+                    const auto a = std::min(last - 1, static_cast<size_t>(begin + c * samplesPerColumn));
+                    const auto b = std::clamp(static_cast<size_t>(begin + (c + 1) * samplesPerColumn), a + 1, last);
+                    const ImVec2 range = state.pyramid.Query(samples, a, b);
+                    const float x = inner.Min.x + static_cast<float>(c) + 0.5f;
+                    state.points.push_back({ x, toY(range.x) });
+                    state.points.push_back({ x, toY(range.y) });
+                }
+            }
+
+            window->DrawList->PushClipRect(inner.Min, inner.Max, true);
+            window->DrawList->AddPolyline(state.points.data(), static_cast<int>(state.points.size()), GetColorU32(hovered ? ImGuiCol_PlotLinesHovered : ImGuiCol_PlotLines), ImDrawFlags_None, 1.f);
+            window->DrawList->PopClipRect();
+
+            if (hovered && inner.Contains(io.MousePos))
+            {
+                const double at = begin + (io.MousePos.x - inner.Min.x) / width * (end - begin);
+                const auto a = std::min(last - 1, static_cast<size_t>(at));
+                if (samplesPerColumn <= 1.0)
+                    SetTooltip("%zu: %g", a, static_cast<double>(samples[a]));
+                else
+                {
+                    const auto b = std::min(last, a + static_cast<size_t>(std::ceil(samplesPerColumn)));
+                    const ImVec2 range = state.pyramid.Query(samples, a, b);
+                    SetTooltip("%zu-%zu: %g .. %g", a, b - 1, range.x, range.y);
+                }
+            }
+        }
+
+        if (labelSize.x > 0.f)
+            RenderText(ImVec2(frame.Max.x + style.ItemInnerSpacing.x, inner.Min.y), label.GetValue(), labelEnd);
+    }
+}
+
+namespace NGui
+{
+    void PlotT::operator()(FormatArgs label, std::span<const float> samples, const Params& params) const
+    {
+        Detail::DrawPlot(label, samples, params);
+    }
+
+    void PlotT::operator()(FormatArgs label, std::span<const double> samples, const Params& params) const
+    {
+        Detail::DrawPlot(label, samples, params);
+    }
+}
+
+namespace NGui::Detail
+{
+    size_t GetMetricShardCount()
+    {
+        static const size_t count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        return count;
+    }
+}
+
+namespace NGui
+{
+    void Metrics::Counter::Fold(float deltaTime)
+    {
+        ImS64 total = 0;
+        for (const auto& shard : shards_)
+            total += shard.value.load(std::memory_order_relaxed);
+
+        rate_ = deltaTime > 0.f ? static_cast<float>(total - total_) / deltaTime : 0.f;
+        total_ = total;
+        PushHistory(rate_);
+    }
+
+    void Metrics::Gauge::Fold(float)
+    {
+        folded_ = value_.value.load(std::memory_order_relaxed);
+        PushHistory(static_cast<float>(folded_));
+    }
+
+    Metrics::Histogram::Histogram(std::string_view name, float min, float max, size_t buckets)
+        : Metric(name), min_(min), max_(max), scale_(max > min ? static_cast<float>(buckets) / (max - min) : 0.f), bucketCount_(buckets),
+          shardStride_((buckets + 2 + CountsPerLine - 1) / CountsPerLine), lines_(shardStride_ * Detail::GetMetricShardCount()), counts_(buckets + 2)
+    {
+        IM_ASSERT(max > min && buckets > 0);
+    }
+
+    void Metrics::Histogram::Fold(float deltaTime)
+    {
+        std::ranges::fill(counts_, 0);
+        for (size_t shard = 0; shard < lines_.size() / shardStride_; ++shard)
+            for (size_t bucket = 0; bucket < counts_.size(); ++bucket)
+                counts_[bucket] += lines_[shard * shardStride_ + bucket / CountsPerLine].counts[bucket % CountsPerLine].load(std::memory_order_relaxed);
+
+        const ImU64 count = std::accumulate(counts_.begin(), counts_.end(), ImU64(0));
+        rate_ = deltaTime > 0.f ? static_cast<float>(count - count_) / deltaTime : 0.f;
+        count_ = count;
+        PushHistory(rate_);
+    }
+
+    float Metrics::Histogram::GetQuantile(float q) const
+    {
+        if (count_ == 0)
+            return 0.f;
+
+        const double target = ImSaturate(q) * static_cast<double>(count_);
+        double below = 0.0;
+        for (size_t bucket = 0; bucket < counts_.size(); ++bucket)
+        {
+            const auto count = static_cast<double>(counts_[bucket]);
+            if (below + count >= target && count > 0.0)
+            {
+                if (bucket == 0)
+                    return min_;
+                if (bucket == counts_.size() - 1)
+                    return max_;
+
+                const float t = static_cast<float>((target - below) / count);
+                return min_ + (static_cast<float>(bucket - 1) + t) / scale_;
+            }
+            below += count;
+        }
+        return max_;
+    }
+
+    struct Metrics::Impl : Detail::FrameHook
+    {
+        // Guards the list against metrics added while folding, producers never take it
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Metric>> metrics;
+        ImGuiContext* context = nullptr;
+
+        void OnNewFrame() override
+        {
+            const float deltaTime = ImGui::GetIO().DeltaTime;
+            std::lock_guard lock(mutex);
+            for (auto& metric : metrics)
+                metric->Fold(deltaTime);
+        }
+
+        template<typename T, typename... Args>
+        T& Add(Args&& ...args)
+        {
+            auto metric = std::make_unique<T>(std::forward<Args>(args)...);
+            T& result = *metric;
+            std::lock_guard lock(mutex);
+            metrics.push_back(std::move(metric));
+            return result;
+        }
+
+        void Register(const std::shared_ptr<Impl>& self)
+        {
+            if (context == GImGui)
+                return;
+
+            IM_ASSERT(context == nullptr && "Metrics can only be folded by one ImGui context.");
+            context = GImGui;
+            Detail::AddFrameHook(self);
+        }
+    };
+
+    Metrics::Metrics()
+        : impl_(std::make_shared<Impl>())
+    {
+        if (GImGui)
+            impl_->Register(impl_);
+    }
+
+    Metrics::~Metrics() = default;
+
+    Metrics::Counter& Metrics::AddCounter(std::string_view name)
+    {
+        return impl_->Add<Counter>(name);
+    }
+
+    Metrics::Gauge& Metrics::AddGauge(std::string_view name, float min, float max)
+    {
+        return impl_->Add<Gauge>(name, min, max);
+    }
+
+    Metrics::Histogram& Metrics::AddHistogram(std::string_view name, float min, float max, size_t buckets)
+    {
+        return impl_->Add<Histogram>(name, min, max, buckets);
+    }
+
+    void MetricsViewT::operator()(FormatArgs id, Metrics& metrics, const Params& params) const
+    {
+        auto& impl = *metrics.impl_;
+        impl.Register(metrics.impl_);
+
+        const bool history = params.historyHeight > 0.f;
+        if (!ImGui::BeginTable(id.GetValue(), history ? 3 : 2, params.flags, params.outerSize))
+            return;
+
+        ImGui::TableSetupColumn("Name");
+        ImGui::TableSetupColumn("Value");
+        if (history)
+            ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        std::lock_guard lock(impl.mutex);
+        for (const auto& metric : impl.metrics)
+        {
+            ImGui::PushID(metric.get());
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(metric->GetName().c_str());
+
+            ImGui::TableNextColumn();
+            if (const auto* counter = dynamic_cast<const Metrics::Counter*>(metric.get()))
+                ImGui::Text("%lld (%.1f/s)", static_cast<long long>(counter->GetTotal()), counter->GetRate());
+            else if (const auto* gauge = dynamic_cast<const Metrics::Gauge*>(metric.get()))
+            {
+                if (gauge->HasRange())
+                    ProgressBar(gauge->GetFraction(), ImVec2(-FLT_MIN, 0.f), { "{:g}", gauge->GetValue() });
+                else
+                    ImGui::Text("%g", gauge->GetValue());
+            }
+            else if (const auto* histogram = dynamic_cast<const Metrics::Histogram*>(metric.get()))
+                ImGui::Text("n=%llu p50=%g p90=%g p99=%g", static_cast<unsigned long long>(histogram->GetCount()), histogram->GetQuantile(0.5f), histogram->GetQuantile(0.9f), histogram->GetQuantile(0.99f));
+
+            if (history)
+            {
+                ImGui::TableNextColumn();
+                ImGui::SetNextItemWidth(-FLT_MIN);
+                // The window slides by a sample every frame, so Plot would rebuild its pyramid each time for only HistoryLength samples
+                const auto samples = metric->GetHistory();
+                ImGui::PlotLines("##history", samples.data(), static_cast<int>(samples.size()), 0, nullptr, FLT_MAX, FLT_MAX, ImVec2(0.f, params.historyHeight));
+            }
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
     }
 }
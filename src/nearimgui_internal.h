@@ -0,0 +1,81 @@
+#pragma once
+// Implementation details of nearimgui.cpp which are not part of the public header, shared with the unit tests.
+
+#include <imgui.h>
+#include <algorithm>
+#include <cfloat>
+#include <span>
+#include <vector>
+
+namespace NGui::Detail
+{
+    // Widens [min, max] to include the samples
+    void ReduceMinMax(const float* samples, size_t count, float& min, float& max);
+    void ReduceMinMax(const double* samples, size_t count, float& min, float& max);
+
+    /**
+     * Min (x) and max (y) of every block of BlockSize << level samples.
+     * Any range then reduces to at most two partial blocks of raw samples plus two entries per level, whatever its length.
+    */
+    class MinMaxPyramid
+    {
+    public:
+        static constexpr size_t BlockSize = 32;
+
+        void Clear() { levels_.clear(); }
+
+        // Adds the blocks completed by samples appended since the last update
+        template<typename T>
+        void Update(std::span<const T> samples)
+        {
+            if (levels_.empty())
+                levels_.emplace_back();
+
+            for (size_t b = levels_[0].size(); b < samples.size() / BlockSize; ++b)
+            {
+                ImVec2 range(FLT_MAX, -FLT_MAX);
+                ReduceMinMax(samples.data() + b * BlockSize, BlockSize, range.x, range.y);
+                levels_[0].push_back(range);
+            }
+
+            for (size_t l = 1; levels_[l - 1].size() >= 2; ++l)
+            {
+                if (levels_.size() == l)
+                    levels_.emplace_back();
+
+                const auto& below = levels_[l - 1];
+                auto& level = levels_[l];
+                for (size_t b = level.size(); b < below.size() / 2; ++b)
+                    level.push_back({ std::min(below[2 * b].x, below[2 * b + 1].x), std::max(below[2 * b].y, below[2 * b + 1].y) });
+            }
+        }
+
+        template<typename T>
+        ImVec2 Query(std::span<const T> samples, size_t begin, size_t end) const
+        {
+            ImVec2 range(FLT_MAX, -FLT_MAX);
+            if (end - begin < 2 * BlockSize)
+            {
+                ReduceMinMax(samples.data() + begin, end - begin, range.x, range.y);
+                return range;
+            }
+
+            size_t i = (begin + BlockSize - 1) / BlockSize, j = end / BlockSize;
+            ReduceMinMax(samples.data() + begin, i * BlockSize - begin, range.x, range.y);
+            ReduceMinMax(samples.data() + j * BlockSize, end - j * BlockSize, range.x, range.y);
+
+            const auto add = [&](const ImVec2& r) { range.x = std::min(range.x, r.x); range.y = std::max(range.y, r.y); };
+            for (size_t l = 0; i < j; ++l, i /= 2, j /= 2)
+            {
+                if (i & 1)
+                    add(levels_[l][i++]);
+                if (j & 1)
+                    add(levels_[l][--j]);
+            }
+            return range;
+        }
+
+    private:
+        std::vector<std::vector<ImVec2>> levels_;
+    };
+}
@@ -2,10 +2,15 @@
 #include <nearimgui.h>
 #include <array>
 #include <iostream>
+#include <thread>
+#include <chrono>
+#include <cmath>
 
 ImFont* fontBig = nullptr;
 ImFont* fontSmall = nullptr;
 
+enum class Shape { Circle, Square, Triangle };
+
 void Setup()
 {
     ImFontConfig cfg{};
@@ -41,11 +46,11 @@ void Demo(size_t frameId)
     auto& io = ImGui::GetIO();
     float ww = animate ? (sin(frameId / 30.f) * 100.f + windowWidth) : 300.f;
 
-    NGui::Window.SizeConstraints([&](ImGuiSizeCallbackData* data) {
+    NGui::Window.SizeConstraints(NGui::Persistent, [&](ImGuiSizeCallbackData* data) {
         data->DesiredSize.x = ww;
         data->DesiredSize.y = 400.f;
         })("Hello, world!", {&open}, [&] {
-        NGui::Checkbox("Animate window size", animate);
+        NGui::Checkbox(NGui::Label{ "Animate window size" }, animate);
         NGui::Text("This is some useful text.");               // Display some text (you can use a format strings too)
 
         NGui::Style(NGui::Style::Alpha{ 0.2f }, NGui::Style::ItemSpacing::Y{ 30.f }, NGui::Style::FramePadding{ 2.f, 2.f }, NGui::Color::Text{0xFF0000FF}, fontBig, [&] {
@@ -60,6 +65,11 @@ void Demo(size_t frameId)
             NGui::Text("This is wrapped in a tuple");
         });
 
+        static const NGui::StyleBlock block(NGui::Style::Alpha{ 0.8f }, NGui::Style::FramePadding{ 4.f, 4.f }, NGui::Color::Text{ 0xFF00FFFF }, fontSmall);
+        block([&] {
+            NGui::Text("This uses a prebuilt style block");
+        });
+
         if (NGui::Button({ "Button {}", counter }))                            // Buttons return true when clicked (most widgets return true when edited/activated)
             counter++;
         ImGui::SameLine();
@@ -80,7 +90,7 @@ void Demo(size_t frameId)
 
         NGui::TextBox("Resizable callback box", resizableBuf, [&](ImGuiInputTextCallbackData*) { resizableBufSizeCb = resizableBuf.capacity(); return 0; });
 
-        NGui::Text({ "Resizable capacity: {}", resizableBufSizeCb });
+        NGui::Text({ NGui::Memoize, "Resizable capacity: {}", resizableBufSizeCb });
 
         NGui::Input("f1 input", f1);
         NGui::Input("f2 input", f2, { .step = 10.f });
@@ -99,7 +109,7 @@ void Demo(size_t frameId)
             });
 
 
-        NGui::TreeNode("treenodeid", "Tree Node ID", [] {
+        NGui::TreeNode(NGui::Label{ "treenodeid" }, "Tree Node ID", [] {
             NGui::Text("whatever");
             });
 
@@ -135,8 +145,17 @@ void Demo(size_t frameId)
         NGui::Text({ "Validated string = {}", validatedString });
 
         NGui::ComboBox("Combo", comboIndex, comboChoices);
+        NGui::ComboBox.Filtered("Filtered combo", comboIndex, comboChoices);
+
+        static constexpr std::pair<std::string_view, int> projectedChoices[]{ { "First", 1 }, { "Second", 2 }, { "Third", 3 } };
+        NGui::ComboBox("Projected combo", comboIndex, projectedChoices, &std::pair<std::string_view, int>::first);
 
-        NGui::ID("Color stuff", [&] {
+        static constexpr NGui::Theme::Definition highContrast{ NGui::Color::Text{ 0xFFFFFFFF }, NGui::Color::FrameBg{ 0xFF000000 }, NGui::Style::FrameBorderSize{ 1.f } };
+        NGui::Theme(highContrast, [&] {
+            NGui::Text("This uses a compile-time theme");
+        });
+
+        NGui::ID(NGui::Label{ "Color stuff" }, [&] {
             float f[3] = { 1.f, 0.f, 1.f };
             NGui::ColorWidget("Color3", f);
             ImVec4 f2{ 1.f, 0.f, 1.f, 0.5f };
@@ -149,6 +168,71 @@ void Demo(size_t frameId)
 
         NGui::ListBox("ListBox", comboIndex, comboChoices);
 
+        static NGui::IndexSet rowSelection;
+        NGui::ListBox.Multi("Multi-select", rowSelection, std::views::iota(0, 5'000'000), [](int row) { return std::format("Row {}", row); });
+        NGui::Text({ "{} rows selected", rowSelection.Size() });
+
+        static Shape shape = Shape::Circle;
+        NGui::EnumCombo("Shape", shape);
+        NGui::EnumRadio("Shape radio", shape, true);
+
+        static ImGuiWindowFlags_ windowFlags = ImGuiWindowFlags_None;
+        NGui::EnumFlags("Window flags", windowFlags);
+
+        static const auto tableRows = [] {
+            std::vector<std::pair<std::string, int>> rows;
+            for (int r = 0; r < 10000; ++r)
+                rows.emplace_back(std::format("Row {}", r), (r * 7919) % 1000);
+            return rows;
+        }();
+        NGui::Table("Table", tableRows, { .outerSize = { 0.f, 200.f } },
+            NGui::TableColumn("Name", &std::pair<std::string, int>::first),
+            NGui::TableColumn("Value", &std::pair<std::string, int>::second, ImGuiTableColumnFlags_DefaultSort));
+
+        // Implicit binary tree with a million nodes
+        static constexpr int treeNodes = 1'000'000;
+        static NGui::IdSet treeSelection;
+        NGui::TreeView("Tree view", std::views::iota(0, 1),
+            [](int node) { return std::views::iota(std::min(2 * node + 1, treeNodes), std::min(2 * node + 3, treeNodes)); },
+            [](int node) { return std::format("Node {}", node); },
+            { .size = { 0.f, 200.f }, .selection = &treeSelection });
+
+        NGui::VirtualList("Virtual list", std::views::iota(0, 100000), [](int row) {
+            NGui::Text({ "Message {}", row });
+            for (int line = 0; line < row % 5; ++line)
+                NGui::Text({ "  detail line {}", line });
+        }, { .size = { 0.f, 200.f } });
+
+        static NGui::TextDocument source(__FILE__, true);
+        NGui::TextView("Text view", source, { .size = { 0.f, 200.f }, .follow = true });
+
+        static NGui::LogBuffer logBuffer;
+        static std::jthread logProducer([](std::stop_token stop) {
+            for (int i = 0; !stop.stop_requested(); ++i)
+            {
+                logBuffer.Push(static_cast<NGui::LogSeverity>(i % 5), "Worker message {}", i);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        });
+        NGui::LogConsole("Log console", logBuffer, { .size = { 0.f, 200.f } });
+
+        static std::vector<float> signal = [] {
+            std::vector<float> samples(10'000'000);
+            for (size_t i = 0; i < samples.size(); ++i)
+                samples[i] = std::sin(i * 0.0005f) + 0.1f * std::sin(i * 0.37f);
+            return samples;
+        }();
+        NGui::Plot("Signal", signal, { .size = { 0.f, 120.f } });
+
+        static NGui::Metrics metrics;
+        static auto& requests = metrics.AddCounter("Requests");
+        static auto& load = metrics.AddGauge("Load", 0.f, 1.f);
+        static auto& latency = metrics.AddHistogram("Latency (ms)", 0.f, 50.f);
+        requests.Add(3);
+        load.Set(0.5 + 0.5 * std::sin(ImGui::GetTime()));
+        latency.Record(static_cast<float>(std::fmod(ImGui::GetTime() * 37.0, 50.0)));
+        NGui::MetricsView("Metrics", metrics, { .historyHeight = 40.f });
+
         NGui::MainMenuBar
             .Menu("File", [](const NGui::Menu& m) {
                 if (m.Item("Open..."))
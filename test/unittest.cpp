@@ -0,0 +1,272 @@
+// Headless checks for NGui: the containers behind the large-list widgets against naive references, and steady-state frames of formatted
+// widgets against the heap. Runs without a window or renderer backend, returns non-zero if any check failed.
+
+#include <imgui.h>
+#include <nearimgui.h>
+#include <nearimgui_internal.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+    // Counts operator new and ImGui's allocator alike, only while enabled
+    std::atomic<bool> g_countAllocations = false;
+    std::atomic<size_t> g_allocations = 0;
+
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (condition)
+            return;
+        std::printf("FAILED: %s\n", what);
+        ++g_failures;
+    }
+
+    void* Allocate(size_t size)
+    {
+        if (g_countAllocations)
+            ++g_allocations;
+        return std::malloc(size != 0 ? size : 1);
+    }
+
+    void* AllocateAligned(size_t size, size_t alignment)
+    {
+        if (g_countAllocations)
+            ++g_allocations;
+#ifdef _WIN32
+        return _aligned_malloc(size != 0 ? size : 1, alignment);
+#else
+        return std::aligned_alloc(alignment, (std::max(size, size_t(1)) + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    void FreeAligned(void* p)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (void* p = Allocate(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* p = AllocateAligned(size, static_cast<size_t>(alignment)))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { FreeAligned(p); }
+
+namespace
+{
+    void TestIdSet()
+    {
+        std::mt19937 rng(1);
+        NGui::IdSet set;
+        std::set<ImGuiID> reference;
+        for (int i = 0; i < 100'000; ++i)
+        {
+            const ImGuiID id = rng() % 5'000 + 1;
+            switch (rng() % 3)
+            {
+            case 0: Check(set.Insert(id) == reference.insert(id).second, "IdSet::Insert"); break;
+            case 1: Check(set.Erase(id) == (reference.erase(id) != 0), "IdSet::Erase"); break;
+            default: Check(set.Contains(id) == reference.contains(id), "IdSet::Contains"); break;
+            }
+        }
+        Check(set.Size() == reference.size(), "IdSet::Size");
+
+        set.Insert(0xFFFFFFFF);
+        reference.insert(0xFFFFFFFF);
+        NGui::IdSet copy;
+        Check(copy.Deserialize(set.Serialize()), "IdSet round trip accepted");
+        std::set<ImGuiID> copied;
+        copy.ForEach([&](ImGuiID id) { copied.insert(id); });
+        Check(copied == reference, "IdSet round trip");
+
+        auto truncated = set.Serialize();
+        truncated.pop_back();
+        Check(!copy.Deserialize(truncated) && copy.Empty(), "IdSet rejects truncated data");
+
+        const ImU8 wrapping[] = { 2, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 2 };
+        Check(!copy.Deserialize(wrapping), "IdSet rejects IDs wrapping around");
+        const ImU8 overlong[] = { 1, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F };
+        Check(!copy.Deserialize(overlong), "IdSet rejects varints past 32 bits");
+    }
+
+    void TestPrefixSums()
+    {
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<float> height(1.f, 40.f);
+        std::vector<float> values(10'000);
+        for (float& v : values)
+            v = height(rng);
+
+        NGui::Detail::PrefixSums sums;
+        sums.Assign(values);
+        for (int i = 0; i < 1'000; ++i)
+        {
+            const size_t index = rng() % values.size();
+            const float delta = height(rng) - values[index];
+            values[index] += delta;
+            sums.Add(index, delta);
+            sums.Append(values.emplace_back(height(rng)));
+        }
+
+        std::vector<double> prefix(values.size() + 1, 0.0);
+        for (size_t i = 0; i < values.size(); ++i)
+            prefix[i + 1] = prefix[i] + values[i];
+
+        Check(sums.Size() == values.size(), "PrefixSums::Size");
+        for (size_t count = 0; count <= values.size(); count += 97)
+            Check(std::abs(sums.Prefix(count) - prefix[count]) < 1e-3, "PrefixSums::Prefix");
+        for (int i = 0; i < 1'000; ++i)
+        {
+            const double offset = std::uniform_real_distribution<double>(0.0, prefix.back())(rng);
+            const size_t expected = std::upper_bound(prefix.begin(), prefix.end(), offset) - prefix.begin() - 1;
+            Check(sums.Find(offset) == expected, "PrefixSums::Find");
+        }
+        Check(sums.Find(prefix.back() + 1.0) == values.size(), "PrefixSums::Find past the end");
+    }
+
+    void TestIndexSet()
+    {
+        constexpr size_t Count = NGui::IndexSet::PageBits * 5 + 123;
+        std::mt19937 rng(3);
+        NGui::IndexSet set;
+        std::vector<bool> reference(Count);
+        for (int i = 0; i < 2'000; ++i)
+        {
+            size_t first = rng() % Count, last = rng() % (Count + 1);
+            if (first > last)
+                std::swap(first, last);
+            if (rng() % 4 == 0)
+                last = std::min(first + rng() % 70, Count);
+
+            const bool present = rng() % 2 == 0;
+            set.SetRange(first, last, present);
+            std::fill(reference.begin() + first, reference.begin() + last, present);
+        }
+
+        Check(set.Size() == static_cast<size_t>(std::count(reference.begin(), reference.end(), true)), "IndexSet::Size");
+        bool contains = true;
+        for (size_t i = 0; i < Count; ++i)
+            contains &= set.Contains(i) == reference[i];
+        Check(contains, "IndexSet::Contains");
+
+        std::vector<size_t> visited;
+        set.ForEach([&](size_t i) { visited.push_back(i); });
+        Check(visited.size() == set.Size() && std::is_sorted(visited.begin(), visited.end()), "IndexSet::ForEach");
+
+        set.Clear();
+        Check(set.Empty() && !set.Contains(0), "IndexSet::Clear");
+    }
+
+    void TestMinMaxPyramid()
+    {
+        std::mt19937 rng(4);
+        std::normal_distribution<float> noise;
+        std::vector<float> samples;
+        NGui::Detail::MinMaxPyramid pyramid;
+
+        // Appended in uneven steps, as Plot sees them
+        for (int step = 0; step < 50; ++step)
+        {
+            const size_t count = rng() % 3'000;
+            for (size_t i = 0; i < count; ++i)
+                samples.push_back(noise(rng) * 100.f);
+            pyramid.Update(std::span<const float>(samples));
+
+            for (int q = 0; q < 20 && !samples.empty(); ++q)
+            {
+                size_t begin = rng() % samples.size(), end = rng() % samples.size();
+                if (begin > end)
+                    std::swap(begin, end);
+                ++end;
+
+                const auto [min, max] = std::minmax_element(samples.begin() + begin, samples.begin() + end);
+                const ImVec2 range = pyramid.Query(std::span<const float>(samples), begin, end);
+                Check(range.x == *min && range.y == *max, "MinMaxPyramid::Query");
+            }
+        }
+    }
+
+    void Frame(int index, float& value)
+    {
+        ImGui::NewFrame();
+        NGui::NewFrame();
+
+        ImGui::Begin("Allocations");
+        NGui::Text({ "Frame {} at {:.3f} ms", index, index * 16.667 });
+        NGui::Button({ "Toggle section {}", index % 3 });
+        NGui::Slider({ "Value {}", index % 2 }, value, 0.f, 1.f);
+        ImGui::End();
+
+        ImGui::Render();
+    }
+
+    // Once warm, formatted widgets must not touch the heap: labels are formatted into the frame arena and measurements are cached
+    void TestSteadyStateAllocations()
+    {
+        ImGui::SetAllocatorFunctions([](size_t size, void*) { return Allocate(size); }, [](void* p, void*) { std::free(p); });
+        ImGui::CreateContext();
+
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+        io.DisplaySize = ImVec2(1280.f, 800.f);
+        io.DeltaTime = 1.f / 60.f;
+        unsigned char* pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+        float value = 0.5f;
+        int frame = 0;
+        for (; frame < 10; ++frame)
+            Frame(frame, value);
+
+        g_allocations = 0;
+        g_countAllocations = true;
+        for (const int end = frame + 3; frame < end; ++frame)
+            Frame(frame, value);
+        g_countAllocations = false;
+
+        if (g_allocations != 0)
+            std::printf("%zu allocations in steady-state frames\n", g_allocations.load());
+        Check(g_allocations == 0, "No allocations in steady-state frames");
+
+        ImGui::DestroyContext();
+    }
+}
+
+int main(int, char**)
+{
+    TestIdSet();
+    TestPrefixSums();
+    TestIndexSet();
+    TestMinMaxPyramid();
+    TestSteadyStateAllocations();
+
+    if (g_failures == 0)
+        std::printf("All checks passed\n");
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}